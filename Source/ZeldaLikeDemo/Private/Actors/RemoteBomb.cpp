@@ -0,0 +1,37 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Actors/RemoteBomb.h"
+
+#include "Components/StaticMeshComponent.h"
+#include "GameFramework/Pawn.h"
+#include "Systems/FireGridSubsystem.h"
+
+// Sets default values
+ARemoteBomb::ARemoteBomb()
+{
+	// Bombs only wait for their detonation
+	PrimaryActorTick.bCanEverTick = false;
+
+	Mesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("Mesh"));
+	RootComponent = Mesh;
+	// A rolling bomb would dirty the navmesh tiles under it every frame
+	Mesh->SetCanEverAffectNavigation(false);
+}
+
+void ARemoteBomb::Detonate()
+{
+	if (UExplosionFieldSubsystem* ExplosionField = GetWorld()->GetSubsystem<UExplosionFieldSubsystem>())
+	{
+		ExplosionField->Detonate(GetActorLocation(), Explosion, this,
+		                         GetInstigator() ? GetInstigator()->GetController() : nullptr);
+	}
+
+	UFireGridSubsystem* FireGrid = GetWorld()->GetSubsystem<UFireGridSubsystem>();
+	if (FireGrid && IgniteRadius > 0.0f)
+	{
+		FireGrid->Ignite(GetActorLocation(), IgniteRadius);
+	}
+
+	Destroy();
+}
@@ -0,0 +1,34 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Actors/WaterRegion.h"
+
+#include "Systems/WaterQuerySubsystem.h"
+
+// Sets default values
+AWaterRegion::AWaterRegion(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	bWaterVolume = true;
+}
+
+// Called when the game starts or when spawned
+void AWaterRegion::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (UWaterQuerySubsystem* WaterQuery = GetWorld()->GetSubsystem<UWaterQuerySubsystem>())
+	{
+		WaterQuery->RegisterWaterRegion(this);
+	}
+}
+
+void AWaterRegion::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UWaterQuerySubsystem* WaterQuery = GetWorld()->GetSubsystem<UWaterQuerySubsystem>())
+	{
+		WaterQuery->UnregisterWaterRegion(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
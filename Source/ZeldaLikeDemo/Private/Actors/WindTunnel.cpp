@@ -3,6 +3,9 @@
 
 #include "Actors/WindTunnel.h"
 
+#include "Systems/TelemetrySubsystem.h"
+#include "Systems/WindFieldSubsystem.h"
+
 
 // Sets default values
 AWindTunnel::AWindTunnel()
@@ -25,8 +28,39 @@ void AWindTunnel::BeginPlay()
 
 	if (bTemporaryWT)
 	{
-		InitialLifeSpan = 30.0f;
+		// AActor::BeginPlay already consumed InitialLifeSpan, set the life span directly
+		SetLifeSpan(30.0f);
+	}
+
+	if (UWindFieldSubsystem* WindField = GetWorld()->GetSubsystem<UWindFieldSubsystem>())
+	{
+		WindField->RegisterWindTunnel(this);
+	}
+
+	if (UTelemetrySubsystem* Telemetry = GetGameInstance()->GetSubsystem<UTelemetrySubsystem>())
+	{
+		// Path names of placed tunnels are the same in every session, FName hashes depend on the name table
+		TelemetryId = FCrc::StrCrc32(*GetPathName());
+		Telemetry->SetSubjectName(TelemetryId, GetPathName());
+	}
+}
+
+void AWindTunnel::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UWindFieldSubsystem* WindField = GetWorld()->GetSubsystem<UWindFieldSubsystem>())
+	{
+		WindField->UnregisterWindTunnel(this);
+	}
+
+	// Streamed out without an end overlap
+	if (PlayerRef && PlayerRef->Telemetry)
+	{
+		const float SecondsInside = GetWorld()->GetTimeSeconds() - PlayerEnterTime;
+		PlayerRef->Telemetry->Record(Telemetry::EEvent::WindTunnelExit, 0, 0, SecondsInside, TelemetryId);
 	}
+	PlayerRef = nullptr;
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -37,7 +71,8 @@ void AWindTunnel::Tick(float DeltaTime)
 
 	if (PlayerRef->CurrentMT != EMovementTypes::MM_GLIDING) return;
 
-	FVector LocalUpVec = GetActorUpVector() * 10.0f;
+	// Scale by the frame time so the lift does not depend on the frame rate
+	FVector LocalUpVec = GetLiftVelocity() * DeltaTime;
 
 	PlayerRef->AddActorWorldOffset(LocalUpVec);
 }
@@ -47,10 +82,39 @@ void AWindTunnel::OnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActo
                                  const FHitResult& SweepResult)
 {
 	PlayerRef = Cast<AMyCharacterBase>(OtherActor);
+
+	if (PlayerRef && PlayerRef->Telemetry)
+	{
+		PlayerEnterTime = GetWorld()->GetTimeSeconds();
+		PlayerRef->Telemetry->Record(Telemetry::EEvent::WindTunnelEnter, 0, 0, 0.0f, TelemetryId);
+	}
 }
 
 void AWindTunnel::OnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor,
                                UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
 {
+	const AMyCharacterBase* Player = Cast<AMyCharacterBase>(OtherActor);
+	if (Player && Player->Telemetry)
+	{
+		const float SecondsInside = GetWorld()->GetTimeSeconds() - PlayerEnterTime;
+		Player->Telemetry->Record(Telemetry::EEvent::WindTunnelExit, 0, 0, SecondsInside, TelemetryId);
+	}
+
 	PlayerRef = nullptr;
 }
+
+bool AWindTunnel::IsLocationInside(const FVector& Location) const
+{
+	if (!Box) return false;
+
+	// Test in box space so rotated tunnels work
+	const FVector LocalLocation = Box->GetComponentTransform().InverseTransformPositionNoScale(Location);
+	const FVector Extent = Box->GetScaledBoxExtent();
+	return FMath::Abs(LocalLocation.X) <= Extent.X && FMath::Abs(LocalLocation.Y) <= Extent.Y &&
+		FMath::Abs(LocalLocation.Z) <= Extent.Z;
+}
+
+FVector AWindTunnel::GetLiftVelocity() const
+{
+	return GetActorUpVector() * LiftSpeed;
+}
@@ -0,0 +1,37 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Animations/MeleeWindowNotifyState.h"
+
+#include "Components/SkeletalMeshComponent.h"
+
+void UMeleeWindowNotifyState::NotifyBegin(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation,
+                                          float TotalDuration, const FAnimNotifyEventReference& EventReference)
+{
+	Super::NotifyBegin(MeshComp, Animation, TotalDuration, EventReference);
+
+	// Editor preview worlds have no combat subsystem
+	UWorld* World = MeshComp ? MeshComp->GetWorld() : nullptr;
+	if (UMeleeCombatSubsystem* MeleeCombat = World ? World->GetSubsystem<UMeleeCombatSubsystem>() : nullptr)
+	{
+		MeleeCombat->BeginSwing(MeshComp, this, Attack);
+	}
+}
+
+void UMeleeWindowNotifyState::NotifyEnd(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation,
+                                        const FAnimNotifyEventReference& EventReference)
+{
+	// Also called when the montage is interrupted inside the window
+	UWorld* World = MeshComp ? MeshComp->GetWorld() : nullptr;
+	if (UMeleeCombatSubsystem* MeleeCombat = World ? World->GetSubsystem<UMeleeCombatSubsystem>() : nullptr)
+	{
+		MeleeCombat->EndSwing(MeshComp, this);
+	}
+
+	Super::NotifyEnd(MeshComp, Animation, EventReference);
+}
+
+FString UMeleeWindowNotifyState::GetNotifyName_Implementation() const
+{
+	return FString::Printf(TEXT("Melee %.0f"), Attack.Damage);
+}
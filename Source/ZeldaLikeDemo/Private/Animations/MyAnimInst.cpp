@@ -3,6 +3,7 @@
 
 #include "Animations/MyAnimInst.h"
 
+#include "Components/InputLatencyComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Kismet/KismetMathLibrary.h"
 
@@ -26,4 +27,12 @@ void UMyAnimInst::NativeUpdateAnimation(float DeltaSeconds)
 	bShouldMove = !bIsFalling && GroundSpeed > 5.0f && MoveComp->GetCurrentAcceleration().Size() > 0;
 	bIsGliding = PlayerRef->CurrentMT == EMovementTypes::MM_GLIDING;
 	bReadyToThrow = PlayerRef->bReadyToThrow;
+	bIsClimbing = PlayerRef->CurrentMT == EMovementTypes::MM_CLIMBING;
+	bIsSwimming = MoveComp->IsSwimming();
+	bIsAttacking = PlayerRef->IsAttacking();
+
+	if (PlayerRef->InputLatency)
+	{
+		PlayerRef->InputLatency->ObserveAnimation(GroundSpeed, bShouldMove, bIsFalling, bIsGliding);
+	}
 }
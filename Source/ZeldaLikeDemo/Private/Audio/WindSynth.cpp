@@ -0,0 +1,137 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Audio/WindSynth.h"
+
+#include "DSP/FloatArrayMath.h"
+
+namespace
+{
+	/** Time for the smoothed parameters to cover most of a change (in seconds) */
+	constexpr float ParamSmoothSeconds = 0.15f;
+
+	/** Wind band center from still air to full airspeed (in Hz) */
+	constexpr float WindMinFrequency = 350.0f;
+	constexpr float WindMaxFrequency = 2400.0f;
+
+	/** Lift rumble cutoff from weak to strong lift (in Hz) */
+	constexpr float LiftMinFrequency = 120.0f;
+	constexpr float LiftMaxFrequency = 420.0f;
+
+	/** Slow gust modulation of the lift rumble (in Hz) */
+	constexpr float GustFrequency = 0.35f;
+
+	/** Breathing band center and cycle rate from light to heavy effort */
+	constexpr float BreathFrequency = 1100.0f;
+	constexpr float BreathMinRate = 0.45f;
+	constexpr float BreathMaxRate = 1.3f;
+
+	/** Voice levels at full parameter value */
+	constexpr float WindLevel = 0.5f;
+	constexpr float LiftLevel = 0.6f;
+	constexpr float BreathLevel = 0.35f;
+
+	/** Ramps below this level on both ends are skipped */
+	constexpr float SilentGain = 1.0e-4f;
+}
+
+void FWindSynth::Init(float InSampleRate, int32 MaxBlockSize)
+{
+	SampleRate = InSampleRate;
+
+	WindFilter.Init(SampleRate, 1, Audio::EBiquadFilter::Bandpass, WindMinFrequency, 1.5f);
+	LiftFilter.Init(SampleRate, 1, Audio::EBiquadFilter::Lowpass, LiftMinFrequency);
+	BreathFilter.Init(SampleRate, 1, Audio::EBiquadFilter::Bandpass, BreathFrequency, 1.0f);
+
+	Noise.SetNumUninitialized(MaxBlockSize);
+	Voice.SetNumUninitialized(MaxBlockSize);
+
+	Current = FParams();
+	WindGain = LiftGain = BreathGain = 0.0f;
+	GustPhase = BreathPhase = 0.0f;
+}
+
+void FWindSynth::Generate(float* OutAudio, int32 NumSamples)
+{
+	if (NumSamples <= 0) return;
+
+	FMemory::Memzero(OutAudio, NumSamples * sizeof(float));
+
+	// Grows once if the device asks for more than Init expected
+	if (Noise.Num() < NumSamples)
+	{
+		Noise.SetNumUninitialized(NumSamples);
+		Voice.SetNumUninitialized(NumSamples);
+	}
+
+	const float BlockSeconds = NumSamples / SampleRate;
+	const float Smoothing = 1.0f - FMath::Exp(-BlockSeconds / ParamSmoothSeconds);
+	Current.Airspeed += (Target.Airspeed - Current.Airspeed) * Smoothing;
+	Current.Lift += (Target.Lift - Current.Lift) * Smoothing;
+	Current.Breath += (Target.Breath - Current.Breath) * Smoothing;
+
+	GustPhase = FMath::Fmod(GustPhase + UE_TWO_PI * GustFrequency * BlockSeconds, UE_TWO_PI);
+	const float BreathRate = FMath::Lerp(BreathMinRate, BreathMaxRate, Current.Breath);
+	BreathPhase = FMath::Fmod(BreathPhase + UE_TWO_PI * BreathRate * BlockSeconds, UE_TWO_PI);
+
+	// Wind grows with the square of airspeed, like drag
+	const float NewWindGain = FMath::Square(Current.Airspeed) * WindLevel;
+	const float NewLiftGain = Current.Lift * (0.7f + 0.3f * FMath::Sin(GustPhase)) * LiftLevel;
+	// Inhale and exhale are the two halves of the cycle, quiet between them
+	const float NewBreathGain = FMath::Square(FMath::Sin(BreathPhase)) * Current.Breath * BreathLevel;
+
+	const bool bWindAudible = FMath::Max(WindGain, NewWindGain) > SilentGain;
+	const bool bLiftAudible = FMath::Max(LiftGain, NewLiftGain) > SilentGain;
+	const bool bBreathAudible = FMath::Max(BreathGain, NewBreathGain) > SilentGain;
+
+	if (bWindAudible || bLiftAudible || bBreathAudible)
+	{
+		GenerateNoise(NumSamples);
+	}
+
+	if (bWindAudible)
+	{
+		WindFilter.SetFrequency(FMath::Lerp(WindMinFrequency, WindMaxFrequency, Current.Airspeed));
+		MixVoice(WindFilter, WindGain, NewWindGain, OutAudio, NumSamples);
+	}
+
+	if (bLiftAudible)
+	{
+		LiftFilter.SetFrequency(FMath::Lerp(LiftMinFrequency, LiftMaxFrequency, Current.Lift));
+		MixVoice(LiftFilter, LiftGain, NewLiftGain, OutAudio, NumSamples);
+	}
+
+	if (bBreathAudible)
+	{
+		MixVoice(BreathFilter, BreathGain, NewBreathGain, OutAudio, NumSamples);
+	}
+
+	WindGain = NewWindGain;
+	LiftGain = NewLiftGain;
+	BreathGain = NewBreathGain;
+}
+
+void FWindSynth::GenerateNoise(int32 NumSamples)
+{
+	// Xorshift, cheaper than FMath::FRand and owned by this synth so the audio thread shares no state
+	float* Samples = Noise.GetData();
+	uint32 State = NoiseState;
+	for (int32 Index = 0; Index < NumSamples; ++Index)
+	{
+		State ^= State << 13;
+		State ^= State >> 17;
+		State ^= State << 5;
+		Samples[Index] = static_cast<int32>(State) * (1.0f / 2147483648.0f);
+	}
+	NoiseState = State;
+}
+
+void FWindSynth::MixVoice(Audio::FBiquadFilter& Filter, float StartGain, float EndGain, float* OutAudio,
+                          int32 NumSamples)
+{
+	Filter.ProcessAudio(Noise.GetData(), NumSamples, Voice.GetData());
+
+	TArrayView<float> VoiceView(Voice.GetData(), NumSamples);
+	Audio::ArrayFade(VoiceView, StartGain, EndGain);
+	Audio::ArrayMixIn(VoiceView, TArrayView<float>(OutAudio, NumSamples));
+}
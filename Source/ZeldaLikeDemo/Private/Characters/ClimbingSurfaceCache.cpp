@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Characters/ClimbingSurfaceCache.h"
+
+#include "ZeldaLikeDemo.h"
+#include "Engine/World.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Climb Probe Traces"), STAT_ClimbProbeTraces, STATGROUP_ZeldaLikeDemo);
+
+void FClimbingSurfaceCache::Anchor(const FVector& WallPoint, const FVector& WallNormal)
+{
+	Origin = WallPoint;
+	Normal = WallNormal.GetSafeNormal();
+	// Right and up as seen by a character facing the wall
+	Right = FVector::CrossProduct(Normal, FVector::UpVector).GetSafeNormal();
+	Up = FVector::CrossProduct(Right, Normal);
+
+	bAnchored = true;
+	bBuilt = false;
+}
+
+void FClimbingSurfaceCache::Reset()
+{
+	bAnchored = false;
+	bBuilt = false;
+}
+
+void FClimbingSurfaceCache::Update(const UWorld* World, const FVector& Location, const FCollisionQueryParams& Params)
+{
+	if (!bAnchored) return;
+
+	FIntPoint NewCenter = ToCell(Location);
+	if (bBuilt && NewCenter == Center) return;
+
+	Shift(World, NewCenter, Params);
+
+	// Curved walls and corners bend away from the plane, re-anchor once on the surface under the character
+	const FCell& Middle = GetCell(0, 0);
+	if (Middle.bHit && FVector::DotProduct(Middle.ImpactNormal, Normal) < ReanchorCosine)
+	{
+		Anchor(Middle.ImpactPoint, Middle.ImpactNormal);
+		NewCenter = ToCell(Location);
+		Shift(World, NewCenter, Params);
+	}
+}
+
+const FClimbingSurfaceCache::FCell& FClimbingSurfaceCache::GetCell(int32 U, int32 V) const
+{
+	const int32 ClampedU = FMath::Clamp(U, -GridRadius, GridRadius) + GridRadius;
+	const int32 ClampedV = FMath::Clamp(V, -GridRadius, GridRadius) + GridRadius;
+	return Cells[ClampedV * GridSize + ClampedU];
+}
+
+FIntPoint FClimbingSurfaceCache::ToCell(const FVector& Location) const
+{
+	const FVector Delta = Location - Origin;
+	return FIntPoint(FMath::RoundToInt32(FVector::DotProduct(Delta, Right) / CellSize),
+	                 FMath::RoundToInt32(FVector::DotProduct(Delta, Up) / CellSize));
+}
+
+void FClimbingSurfaceCache::Shift(const UWorld* World, const FIntPoint& NewCenter, const FCollisionQueryParams& Params)
+{
+	FCell Previous[GridSize * GridSize];
+	FMemory::Memcpy(Previous, Cells, sizeof(Cells));
+
+	for (int32 V = -GridRadius; V <= GridRadius; ++V)
+	{
+		for (int32 U = -GridRadius; U <= GridRadius; ++U)
+		{
+			FCell& Cell = Cells[(V + GridRadius) * GridSize + U + GridRadius];
+			Cell.Coord = NewCenter + FIntPoint(U, V);
+
+			// Cells still inside the old grid keep their probe
+			const FIntPoint OldIndex = Cell.Coord - Center + FIntPoint(GridRadius, GridRadius);
+			if (bBuilt && OldIndex.X >= 0 && OldIndex.X < GridSize && OldIndex.Y >= 0 && OldIndex.Y < GridSize)
+			{
+				Cell = Previous[OldIndex.Y * GridSize + OldIndex.X];
+			}
+			else
+			{
+				TraceCell(World, Cell, Params);
+			}
+		}
+	}
+
+	Center = NewCenter;
+	bBuilt = true;
+}
+
+void FClimbingSurfaceCache::TraceCell(const UWorld* World, FCell& Cell, const FCollisionQueryParams& Params)
+{
+	const FVector CellPoint = Origin + Right * (Cell.Coord.X * CellSize) + Up * (Cell.Coord.Y * CellSize);
+	const FVector Start = CellPoint + Normal * ProbeOffset;
+	const FVector End = CellPoint - Normal * ProbeDepth;
+
+	FHitResult Hit;
+	const bool bBlocked = World->LineTraceSingleByChannel(Hit, Start, End, ECC_Visibility, Params);
+	++NumTraces;
+	INC_DWORD_STAT(STAT_ClimbProbeTraces);
+
+	// Floors and ledge tops block the probe but cannot be climbed
+	Cell.bHit = bBlocked && FMath::Abs(Hit.ImpactNormal.Z) < MaxClimbableNormalZ;
+	Cell.ImpactPoint = Hit.ImpactPoint;
+	Cell.ImpactNormal = Hit.ImpactNormal;
+}
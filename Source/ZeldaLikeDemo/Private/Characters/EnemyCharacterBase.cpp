@@ -0,0 +1,195 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Characters/EnemyCharacterBase.h"
+
+#include "AIController.h"
+#include "Components/CapsuleComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Systems/EnemyPerceptionSubsystem.h"
+
+namespace
+{
+	constexpr float SuspiciousLevel = 0.3f;
+
+	/** Distance the move target has to shift before the enemy repaths */
+	constexpr float RepathDistance = 200.0f;
+}
+
+// Sets default values
+AEnemyCharacterBase::AEnemyCharacterBase()
+{
+	// Perception and decisions run in UEnemyPerceptionSubsystem, movement in the AI controller
+	PrimaryActorTick.bCanEverTick = false;
+
+	AutoPossessAI = EAutoPossessAI::PlacedInWorldOrSpawned;
+
+	GetCharacterMovement()->bOrientRotationToMovement = true;
+	GetCharacterMovement()->MaxWalkSpeed = IdleSpeed;
+}
+
+// Called when the game starts or when spawned
+void AEnemyCharacterBase::BeginPlay()
+{
+	Super::BeginPlay();
+
+	LastKnownLocation = GetActorLocation();
+	Health = MaxHealth;
+	// Blueprints and placed instances may override the speed the constructor used
+	GetCharacterMovement()->MaxWalkSpeed = IdleSpeed;
+
+	if (UEnemyPerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UEnemyPerceptionSubsystem>())
+	{
+		Perception->RegisterEnemy(this);
+	}
+}
+
+void AEnemyCharacterBase::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UEnemyPerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UEnemyPerceptionSubsystem>())
+	{
+		Perception->UnregisterEnemy(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+bool AEnemyCharacterBase::IsInSightCone(const FVector& Location) const
+{
+	const FVector ToLocation = Location - GetPawnViewLocation();
+	const double DistanceSquared = ToLocation.SizeSquared();
+	if (DistanceSquared > FMath::Square(SightRadius)) return false;
+	if (DistanceSquared < KINDA_SMALL_NUMBER) return true;
+
+	const double CosAngle = FVector::DotProduct(ToLocation / FMath::Sqrt(DistanceSquared), GetActorForwardVector());
+	return CosAngle >= FMath::Cos(FMath::DegreesToRadians(SightHalfAngle));
+}
+
+void AEnemyCharacterBase::ApplyPerception(bool bSeen, bool bHeard, const FVector& PlayerLocation, float DeltaTime)
+{
+	if (bSeen)
+	{
+		// Spotted faster up close
+		const float Distance = FVector::Dist(GetActorLocation(), PlayerLocation);
+		const float Falloff = 1.0f - FMath::Clamp(Distance / SightRadius, 0.0f, 0.9f);
+		AwarenessLevel = FMath::Min(AwarenessLevel + AwarenessGain * Falloff * DeltaTime, 1.0f);
+		LastKnownLocation = PlayerLocation;
+	}
+	else if (bHeard)
+	{
+		// Noise alone makes the enemy look, not chase
+		AwarenessLevel = FMath::Max(AwarenessLevel, SuspiciousLevel);
+		LastKnownLocation = PlayerLocation;
+	}
+	else
+	{
+		AwarenessLevel = FMath::Max(AwarenessLevel - AwarenessDecay * DeltaTime, 0.0f);
+	}
+
+	EEnemyAwareness NewAwareness = EEnemyAwareness::EA_IDLE;
+	if (AwarenessLevel >= 1.0f || (Awareness == EEnemyAwareness::EA_ALERTED && AwarenessLevel >= SuspiciousLevel))
+	{
+		NewAwareness = EEnemyAwareness::EA_ALERTED;
+	}
+	else if (AwarenessLevel >= SuspiciousLevel)
+	{
+		NewAwareness = EEnemyAwareness::EA_SUSPICIOUS;
+	}
+
+	if (NewAwareness != Awareness)
+	{
+		const EEnemyAwareness OldAwareness = Awareness;
+		Awareness = NewAwareness;
+		OnAwarenessChanged(OldAwareness, NewAwareness);
+	}
+
+	Decide();
+}
+
+void AEnemyCharacterBase::Decide()
+{
+	AAIController* AIController = Cast<AAIController>(GetController());
+	if (!AIController) return;
+
+	if (Awareness == EEnemyAwareness::EA_IDLE)
+	{
+		if (!MoveTarget.IsZero())
+		{
+			GetCharacterMovement()->MaxWalkSpeed = IdleSpeed;
+			AIController->StopMovement();
+			MoveTarget = FVector::ZeroVector;
+		}
+		return;
+	}
+
+	if (Awareness == EEnemyAwareness::EA_ALERTED && AttackMontage &&
+		FVector::DistSquared(GetActorLocation(), LastKnownLocation) < FMath::Square(AttackRange))
+	{
+		// Stand and swing, the montage's melee windows do the hit detection
+		if (GetCurrentMontage() != AttackMontage)
+		{
+			AIController->StopMovement();
+			MoveTarget = FVector::ZeroVector;
+			SetActorRotation(FRotator(0.0f, (LastKnownLocation - GetActorLocation()).Rotation().Yaw, 0.0f));
+			PlayAnimMontage(AttackMontage);
+		}
+		return;
+	}
+
+	if (!MoveTarget.IsZero() && FVector::DistSquared(MoveTarget, LastKnownLocation) < FMath::Square(RepathDistance))
+		return;
+
+	MoveTarget = LastKnownLocation;
+	GetCharacterMovement()->MaxWalkSpeed = Awareness == EEnemyAwareness::EA_ALERTED ? AlertedSpeed : SuspiciousSpeed;
+	AIController->MoveToLocation(MoveTarget, 50.0f);
+}
+
+float AEnemyCharacterBase::TakeDamage(float DamageAmount, const FDamageEvent& DamageEvent,
+                                      AController* EventInstigator, AActor* DamageCauser)
+{
+	const float Damage = Super::TakeDamage(DamageAmount, DamageEvent, EventInstigator, DamageCauser);
+	if (Damage <= 0.0f || Health <= 0.0f) return Damage;
+
+	Health = FMath::Max(Health - Damage, 0.0f);
+	if (Health <= 0.0f)
+	{
+		Die(DamageCauser);
+		return Damage;
+	}
+
+	// Getting hit gives the attacker away
+	if (DamageCauser)
+	{
+		LastKnownLocation = DamageCauser->GetActorLocation();
+		AwarenessLevel = 1.0f;
+		if (Awareness != EEnemyAwareness::EA_ALERTED)
+		{
+			const EEnemyAwareness OldAwareness = Awareness;
+			Awareness = EEnemyAwareness::EA_ALERTED;
+			OnAwarenessChanged(OldAwareness, Awareness);
+		}
+		Decide();
+	}
+	return Damage;
+}
+
+void AEnemyCharacterBase::Die(AActor* Killer)
+{
+	if (UEnemyPerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UEnemyPerceptionSubsystem>())
+	{
+		Perception->UnregisterEnemy(this);
+	}
+
+	if (AAIController* AIController = Cast<AAIController>(GetController()))
+	{
+		AIController->StopMovement();
+	}
+
+	StopAnimMontage();
+	GetCharacterMovement()->DisableMovement();
+	GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	SetCanBeDamaged(false);
+	OnDeath(Killer);
+
+	SetLifeSpan(CorpseLifeSpan);
+}
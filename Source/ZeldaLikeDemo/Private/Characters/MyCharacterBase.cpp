@@ -2,10 +2,23 @@
 
 
 #include "Characters/MyCharacterBase.h"
+#include "ZeldaLikeDemo.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/InputLatencyComponent.h"
+#include "Components/StreamingLookAheadComponent.h"
+#include "Components/TrajectoryPredictionComponent.h"
+#include "Components/WindAudioComponent.h"
 #include "Data/MyPlayerController.h"
+#include "Data/PlayerBootstrapData.h"
 #include "EnhancedInputSubsystems.h"
 #include "EnhancedInputComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
+#include "Systems/FireGridSubsystem.h"
+#include "Systems/GliderPoolSubsystem.h"
+#include "Systems/PlayerBootstrapSubsystem.h"
+#include "Systems/RuneNavigationSubsystem.h"
+#include "Systems/TelemetrySubsystem.h"
+#include "Systems/WaterQuerySubsystem.h"
 #include "UI/MyLayout.h"
 #include "Debug/DebugHelper.h"
 #include "DrawDebugHelpers.h"
@@ -30,9 +43,11 @@ AMyCharacterBase::AMyCharacterBase()
 	FollowCamera->SetupAttachment(CameraBoom);
 	FollowCamera->bUsePawnControlRotation = false;
 
-	Parachute = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("Parachute"));
-	Parachute->SetupAttachment(GetMesh());
-	Parachute->SetVisibility(false);
+	TrajectoryPredictor = CreateDefaultSubobject<UTrajectoryPredictionComponent>(TEXT("TrajectoryPredictor"));
+	InputLatency = CreateDefaultSubobject<UInputLatencyComponent>(TEXT("InputLatency"));
+	StreamingLookAhead = CreateDefaultSubobject<UStreamingLookAheadComponent>(TEXT("StreamingLookAhead"));
+	WindAudio = CreateDefaultSubobject<UWindAudioComponent>(TEXT("WindAudio"));
+	WindAudio->SetupAttachment(RootComponent);
 
 	// Set player rotates toward the direction according to inputs
 	GetCharacterMovement()->bOrientRotationToMovement = true;
@@ -45,6 +60,22 @@ void AMyCharacterBase::BeginPlay()
 {
 	Super::BeginPlay();
 
+	LastDryLocation = GetActorLocation();
+	CurrentHealth = MaxHealth;
+	Telemetry = GetGameInstance()->GetSubsystem<UTelemetrySubsystem>();
+
+	// The bundle usually arrives during map load, in which case this calls back immediately
+	if (UPlayerBootstrapSubsystem* Bootstrap = GetGameInstance()->GetSubsystem<UPlayerBootstrapSubsystem>())
+	{
+		Bootstrap->CallOrRegister_OnBootstrapLoaded(
+			FOnPlayerBootstrapLoaded::FDelegate::CreateUObject(this, &AMyCharacterBase::OnBootstrapLoaded));
+	}
+}
+
+void AMyCharacterBase::OnBootstrapLoaded(const UPlayerBootstrapData* Data)
+{
+	BootstrapData = Data;
+
 	TObjectPtr<AMyPlayerController> PC = Cast<AMyPlayerController>(GetController());
 	if (!PC) return;
 
@@ -53,15 +84,18 @@ void AMyCharacterBase::BeginPlay()
 		UEnhancedInputLocalPlayerSubsystem>(PC->GetLocalPlayer());
 	if (!Subsystem) return;
 
-	Subsystem->AddMappingContext(MappingContext, 0);
+	if (BootstrapData)
+	{
+		Subsystem->AddMappingContext(BootstrapData->MappingContext.Get(), 0);
+	}
 
 	// Initialize Stamina
 	CurrentStamina = MaxStamina;
 
 	// Create stamina UI
-	if (LayoutClassRef)
+	if (BootstrapData && BootstrapData->LayoutClass.Get())
 	{
-		LayoutRef = CreateWidget<UMyLayout>(GetWorld(), LayoutClassRef);
+		LayoutRef = CreateWidget<UMyLayout>(GetWorld(), BootstrapData->LayoutClass.Get());
 		if (LayoutRef)
 		{
 			// Trigger ConstructDeferred event
@@ -69,12 +103,36 @@ void AMyCharacterBase::BeginPlay()
 			LayoutRef->AddToViewport();
 		}
 	}
+
+	if (UPlayerBootstrapSubsystem* Bootstrap = GetGameInstance()->GetSubsystem<UPlayerBootstrapSubsystem>())
+	{
+		Bootstrap->NotifyPlayerReady();
+	}
+}
+
+void AMyCharacterBase::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	GetWorldTimerManager().ClearTimer(ReleaseParachuteTimerHandle);
+	ReleaseParachute();
+
+	if (NumClimbFrames > 0)
+	{
+		// A naive probe traces the wall, the ledge and both sides every frame
+		constexpr int32 NaiveTracesPerFrame = 4;
+		UE_LOG(LogZeldaLikeDemo, Display, TEXT("Climbing: %llu frames, %llu probe traces (%.2f per frame, naive probe %d)"),
+		       NumClimbFrames, ClimbSurface.GetNumTraces(),
+		       static_cast<double>(ClimbSurface.GetNumTraces()) / NumClimbFrames, NaiveTracesPerFrame);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void AMyCharacterBase::Landed(const FHitResult& Hit)
 {
 	Super::Landed(Hit);
 
+	LastDryLocation = GetActorLocation();
+
 	if (CurrentMT == EMovementTypes::MM_EXHAUSTED)
 	{
 		StartRecoverStamina();
@@ -104,6 +162,76 @@ void AMyCharacterBase::Landed(const FHitResult& Hit)
 void AMyCharacterBase::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
+
+	// Applied per tick rather than from a timer whose rate was the frame time when gliding started
+	if (CurrentMT == EMovementTypes::MM_GLIDING)
+	{
+		AddGravityForFlying();
+		RideThermals(DeltaTime);
+	}
+	else if (CurrentMT == EMovementTypes::MM_CLIMBING)
+	{
+		UpdateClimbing();
+	}
+
+	// Also covers exhausted swimmers, who sink
+	if (GetCharacterMovement()->IsSwimming())
+	{
+		UpdateSwimming(DeltaTime);
+	}
+}
+
+void AMyCharacterBase::MoveBlockedBy(const FHitResult& Impact)
+{
+	Super::MoveBlockedBy(Impact);
+
+	if (CurrentMT == EMovementTypes::MM_CLIMBING)
+	{
+		// Climbing down onto the ground
+		if (Impact.ImpactNormal.Z >= ClimbSurface.MaxClimbableNormalZ && Velocity_Y < 0)
+		{
+			LocomotionManager(EMovementTypes::MM_WALKING);
+		}
+		return;
+	}
+
+	TryStartClimbing(Impact);
+}
+
+void AMyCharacterBase::OnMovementModeChanged(EMovementMode PrevMovementMode, uint8 PreviousCustomMode)
+{
+	Super::OnMovementModeChanged(PrevMovementMode, PreviousCustomMode);
+
+	const EMovementMode NewMovementMode = GetCharacterMovement()->MovementMode;
+	if (NewMovementMode == MOVE_Swimming && CurrentMT != EMovementTypes::MM_SWIMMING)
+	{
+		if (CurrentMT == EMovementTypes::MM_EXHAUSTED)
+		{
+			// Fell into water without stamina, sink
+			SetExhausted();
+		}
+		else
+		{
+			LocomotionManager(EMovementTypes::MM_SWIMMING);
+		}
+	}
+	else if (PrevMovementMode == MOVE_Swimming && NewMovementMode != MOVE_Swimming)
+	{
+		GetCharacterMovement()->Buoyancy = SwimBuoyancy;
+
+		// Climbed out onto the shore or jumped out of the water
+		if (CurrentMT == EMovementTypes::MM_SWIMMING)
+		{
+			LocomotionManager(NewMovementMode == MOVE_Walking
+				                  ? EMovementTypes::MM_WALKING
+				                  : EMovementTypes::MM_FALLING);
+		}
+		// Left the water exhausted, stamina does not recover while in it
+		else if (CurrentMT == EMovementTypes::MM_EXHAUSTED)
+		{
+			StartRecoverStamina();
+		}
+	}
 }
 
 // Called to bind functionality to input
@@ -124,18 +252,37 @@ void AMyCharacterBase::SetupPlayerInputComponent(UInputComponent* PlayerInputCom
 
 		EIComp->BindAction(JumpGlideAction, ETriggerEvent::Completed, this, &AMyCharacterBase::JumpGlide_Completed);
 		EIComp->BindAction(JumpGlideAction, ETriggerEvent::Started, this, &AMyCharacterBase::JumpGlide_Started);
+
+		EIComp->BindAction(AttackAction, ETriggerEvent::Started, this, &AMyCharacterBase::Attack_Started);
 	}
 }
 
 #pragma region Move & Camera
 void AMyCharacterBase::Move_Triggered(const FInputActionValue& val)
 {
+	// Only the first input after the stick was released starts a new motion
+	if (Velocity_X == 0 && Velocity_Y == 0)
+	{
+		InputLatency->TagInput(ELatencyInputs::LI_MOVE);
+	}
+
 	const FVector2D InputVector = val.Get<FVector2D>();
 	Velocity_X = InputVector.X;
 	Velocity_Y = InputVector.Y;
 
 	if (!Controller) return;
 
+	if (CurrentMT == EMovementTypes::MM_CLIMBING)
+	{
+		// Do not climb sideways off the surface
+		const int32 Side = FMath::Sign(Velocity_X);
+		const float ClimbX = Side != 0 && !ClimbSurface.GetCell(Side, 0).bHit ? 0.0f : Velocity_X;
+
+		AddMovementInput(ClimbSurface.GetRight(), ClimbX);
+		AddMovementInput(ClimbSurface.GetUp(), Velocity_Y);
+		return;
+	}
+
 	// Only focus on Yaw horizontally
 	const FRotator GroundRotation(0, Controller->GetControlRotation().Yaw, 0);
 
@@ -171,14 +318,24 @@ void AMyCharacterBase::Sprint_Triggered(const FInputActionValue& val)
 	{
 		LocomotionManager(EMovementTypes::MM_WALKING);
 	}
+	else if (Velocity_X == 0 && Velocity_Y == 0 && bSwimSprinting)
+	{
+		SetSwimSprint(false);
+	}
 }
 
 void AMyCharacterBase::Sprint_Started(const FInputActionValue& val)
 {
+	InputLatency->TagInput(ELatencyInputs::LI_SPRINT);
+
 	if (CurrentMT == EMovementTypes::MM_WALKING || CurrentMT == EMovementTypes::MM_MAX)
 	{
 		LocomotionManager(EMovementTypes::MM_SPRINTING);
 	}
+	else if (CurrentMT == EMovementTypes::MM_SWIMMING)
+	{
+		SetSwimSprint(true);
+	}
 }
 
 void AMyCharacterBase::Sprint_Completed(const FInputActionValue& val)
@@ -187,11 +344,28 @@ void AMyCharacterBase::Sprint_Completed(const FInputActionValue& val)
 	{
 		LocomotionManager(EMovementTypes::MM_WALKING);
 	}
+	else if (CurrentMT == EMovementTypes::MM_SWIMMING)
+	{
+		SetSwimSprint(false);
+	}
 }
 
 void AMyCharacterBase::JumpGlide_Started(const FInputActionValue& val)
 {
-	if (CurrentMT == EMovementTypes::MM_EXHAUSTED) return;
+	InputLatency->TagInput(ELatencyInputs::LI_JUMPGLIDE);
+
+	// Cannot jump or glide out of water
+	if (CurrentMT == EMovementTypes::MM_EXHAUSTED || CurrentMT == EMovementTypes::MM_SWIMMING) return;
+
+	if (CurrentMT == EMovementTypes::MM_CLIMBING)
+	{
+		// Jump away from the wall
+		const FVector WallNormal = ClimbSurface.GetNormal();
+		LocomotionManager(EMovementTypes::MM_FALLING);
+		LaunchCharacter((WallNormal + FVector::UpVector) * ClimbJumpOffSpeed, true, true);
+		return;
+	}
+
 	if (GetCharacterMovement()->MovementMode != MOVE_Falling)
 	{
 		// Save previous status
@@ -242,18 +416,64 @@ void AMyCharacterBase::JumpGlide_Completed(const FInputActionValue& val)
 	StopJumping();
 }
 
+void AMyCharacterBase::Attack_Started(const FInputActionValue& val)
+{
+	if (!AttackMontage || IsAttacking()) return;
+
+	// Only on the ground, and not while out of breath
+	if (CurrentMT != EMovementTypes::MM_WALKING && CurrentMT != EMovementTypes::MM_SPRINTING && CurrentMT !=
+		EMovementTypes::MM_MAX)
+		return;
+
+	PlayAnimMontage(AttackMontage);
+}
+
+bool AMyCharacterBase::IsAttacking() const
+{
+	return AttackMontage && GetCurrentMontage() == AttackMontage;
+}
+
+float AMyCharacterBase::TakeDamage(float DamageAmount, const FDamageEvent& DamageEvent, AController* EventInstigator,
+                                   AActor* DamageCauser)
+{
+	const float Damage = Super::TakeDamage(DamageAmount, DamageEvent, EventInstigator, DamageCauser);
+	if (Damage <= 0.0f || CurrentHealth <= 0.0f) return Damage;
+
+	CurrentHealth = FMath::Max(CurrentHealth - Damage, 0.0f);
+	if (CurrentHealth <= 0.0f)
+	{
+		StopAnimMontage();
+		GetCharacterMovement()->StopMovementImmediately();
+		SetActorLocation(LastDryLocation, false, nullptr, ETeleportType::TeleportPhysics);
+		LocomotionManager(EMovementTypes::MM_WALKING);
+		CurrentHealth = MaxHealth;
+	}
+	return Damage;
+}
+
 #pragma region Locomotions
 void AMyCharacterBase::LocomotionManager(EMovementTypes NewMovement)
 {
 	// Control movement
 	if (NewMovement == CurrentMT) return;
 
+	if (Telemetry)
+	{
+		Telemetry->Record(Telemetry::EEvent::LocomotionChanged, static_cast<uint8>(CurrentMT),
+		                  static_cast<uint8>(NewMovement), CurrentStamina);
+	}
+
+	if (CurrentMT == EMovementTypes::MM_CLIMBING)
+	{
+		EndClimbing();
+	}
+
 	CurrentMT = NewMovement;
 
-	// Show or hide the glider model
-	if (Parachute)
+	// Hide the glider model, SetGliding shows it again
+	if (CurrentMT != EMovementTypes::MM_GLIDING)
 	{
-		Parachute->SetVisibility(CurrentMT == EMovementTypes::MM_GLIDING);
+		HideParachute();
 	}
 
 	switch (CurrentMT)
@@ -275,6 +495,12 @@ void AMyCharacterBase::LocomotionManager(EMovementTypes NewMovement)
 	case EMovementTypes::MM_FALLING:
 		SetFalling();
 		break;
+	case EMovementTypes::MM_CLIMBING:
+		SetClimbing();
+		break;
+	case EMovementTypes::MM_SWIMMING:
+		SetSwimming();
+		break;
 	}
 }
 
@@ -282,8 +508,6 @@ void AMyCharacterBase::LocomotionManager(EMovementTypes NewMovement)
 
 void AMyCharacterBase::ResetToWalk()
 {
-	// If gravity added, cancel it
-	GetWorldTimerManager().ClearTimer(AddGravityForFlyingTimerHandle);
 	// Reset to ground status
 	GetCharacterMovement()->SetMovementMode(MOVE_Walking);
 }
@@ -312,6 +536,8 @@ void AMyCharacterBase::SetWalking()
 
 void AMyCharacterBase::SetGliding()
 {
+	ShowParachute();
+
 	GetCharacterMovement()->AirControl = 0.6f;
 
 	// Set flying mode 
@@ -319,11 +545,8 @@ void AMyCharacterBase::SetGliding()
 
 	StartDrainStamina();
 
-	// Set gravity simulation, execute each frame
+	// Set gravity simulation, Tick keeps applying it every frame
 	AddGravityForFlying();
-
-	GetWorldTimerManager().SetTimer(AddGravityForFlyingTimerHandle, this, &AMyCharacterBase::AddGravityForFlying,
-	                                GetWorld()->GetDeltaSeconds(), true);
 }
 
 void AMyCharacterBase::SetFalling()
@@ -335,6 +558,232 @@ void AMyCharacterBase::SetFalling()
 	ClearDrainRecoverStaminaTimer();
 }
 
+void AMyCharacterBase::ShowParachute()
+{
+	GetWorldTimerManager().ClearTimer(ReleaseParachuteTimerHandle);
+
+	if (!Parachute)
+	{
+		UGliderPoolSubsystem* GliderPool = GetWorld()->GetSubsystem<UGliderPoolSubsystem>();
+		if (!GliderPool) return;
+
+		Parachute = GliderPool->AcquireGlider(BootstrapData ? BootstrapData->ParachuteMesh.Get() : nullptr);
+		if (!Parachute) return;
+
+		Parachute->AttachToComponent(GetMesh(), FAttachmentTransformRules::SnapToTargetNotIncludingScale,
+		                             ParachuteSocket);
+		Parachute->SetRelativeTransform(ParachuteRelativeTransform);
+	}
+
+	Parachute->SetComponentTickEnabled(true);
+	Parachute->SetVisibility(true);
+}
+
+void AMyCharacterBase::HideParachute()
+{
+	if (!Parachute || GetWorldTimerManager().IsTimerActive(ReleaseParachuteTimerHandle)) return;
+
+	Parachute->SetVisibility(false);
+	Parachute->SetComponentTickEnabled(false);
+
+	// Keep it for a while, players often glide again right after landing
+	GetWorldTimerManager().SetTimer(ReleaseParachuteTimerHandle, this, &AMyCharacterBase::ReleaseParachute,
+	                                ParachuteReleaseDelay, false);
+}
+
+void AMyCharacterBase::ReleaseParachute()
+{
+	if (!Parachute) return;
+
+	if (UGliderPoolSubsystem* GliderPool = GetWorld()->GetSubsystem<UGliderPoolSubsystem>())
+	{
+		GliderPool->ReleaseGlider(Parachute);
+	}
+	Parachute = nullptr;
+}
+
+void AMyCharacterBase::SetClimbing()
+{
+	GetCharacterMovement()->MaxFlySpeed = ClimbSpeed;
+	// Face the wall instead of the movement direction
+	GetCharacterMovement()->bOrientRotationToMovement = false;
+	GetCharacterMovement()->StopMovementImmediately();
+
+	// Flying mode has no gravity, UpdateClimbing keeps the character on the wall
+	GetCharacterMovement()->SetMovementMode(MOVE_Flying);
+
+	StartDrainStamina();
+}
+
+void AMyCharacterBase::EndClimbing()
+{
+	GetCharacterMovement()->bOrientRotationToMovement = true;
+	ClimbSurface.Reset();
+}
+
+void AMyCharacterBase::TryStartClimbing(const FHitResult& Wall)
+{
+	if (CurrentMT == EMovementTypes::MM_EXHAUSTED || CurrentStamina <= 0.0f) return;
+
+	// Only steep surfaces the player is pushing against
+	if (FMath::Abs(Wall.ImpactNormal.Z) >= ClimbSurface.MaxClimbableNormalZ) return;
+	if (FVector::DotProduct(GetCharacterMovement()->GetCurrentAcceleration().GetSafeNormal(), -Wall.ImpactNormal) <
+		0.5f)
+		return;
+
+	ClimbSurface.Anchor(Wall.ImpactPoint, Wall.ImpactNormal);
+	LocomotionManager(EMovementTypes::MM_CLIMBING);
+}
+
+void AMyCharacterBase::UpdateClimbing()
+{
+	++NumClimbFrames;
+
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(ClimbProbe), false, this);
+	ClimbSurface.Update(GetWorld(), GetActorLocation(), Params);
+
+	const FClimbingSurfaceCache::FCell& Under = ClimbSurface.GetCell(0, 0);
+	if (!Under.bHit)
+	{
+		// The surface ended below or beside the character, let go
+		LocomotionManager(EMovementTypes::MM_FALLING);
+		return;
+	}
+
+	// Pull up when the wall ends just above the head
+	if (Velocity_Y > 0 && ClimbSurface.GetCell(0, 1).bHit && !ClimbSurface.GetCell(0, 2).bHit)
+	{
+		const UCapsuleComponent* Capsule = GetCapsuleComponent();
+		const FVector WallNormal = Under.ImpactNormal;
+		LocomotionManager(EMovementTypes::MM_WALKING);
+		AddActorWorldOffset(FVector::UpVector * Capsule->GetScaledCapsuleHalfHeight() * 2.0f, true);
+		AddActorWorldOffset(-WallNormal * Capsule->GetScaledCapsuleRadius() * 2.0f, true);
+		return;
+	}
+
+	// Face the wall and hold the capsule at a fixed distance from it
+	SetActorRotation(FRotator(0.0f, (-Under.ImpactNormal).Rotation().Yaw, 0.0f));
+	const float Distance = FVector::DotProduct(GetActorLocation() - Under.ImpactPoint, Under.ImpactNormal);
+	const float Desired = GetCapsuleComponent()->GetScaledCapsuleRadius() + ClimbWallGap;
+	AddActorWorldOffset(Under.ImpactNormal * (Desired - Distance));
+}
+
+void AMyCharacterBase::SetSwimming()
+{
+	GetCharacterMovement()->Buoyancy = SwimBuoyancy;
+	SetSwimSprint(false);
+
+	// Usually already set, the movement component switches when it enters a water volume
+	if (!GetCharacterMovement()->IsSwimming())
+	{
+		GetCharacterMovement()->SetMovementMode(MOVE_Swimming);
+	}
+}
+
+void AMyCharacterBase::SetSwimSprint(bool bSprint)
+{
+	bSwimSprinting = bSprint;
+	GetCharacterMovement()->MaxSwimSpeed = bSprint ? SwimSprintSpeed : SwimSpeed;
+
+	if (bSprint)
+	{
+		StartDrainStamina();
+	}
+	else
+	{
+		// Treading water neither drains nor recovers
+		ClearDrainRecoverStaminaTimer();
+	}
+}
+
+void AMyCharacterBase::UpdateSwimming(float DeltaTime)
+{
+	UWaterQuerySubsystem* WaterQuery = GetWorld()->GetSubsystem<UWaterQuerySubsystem>();
+	if (!WaterQuery) return;
+
+	const FVector Location = GetActorLocation();
+	const FWaterSample Water = WaterQuery->Query(Location);
+	if (!Water.bHasWater) return;
+
+	FVector Offset = Water.Flow * DeltaTime;
+	if (CurrentMT == EMovementTypes::MM_EXHAUSTED)
+	{
+		// Shallow water has no room to sink DrownDepth, the bottom of the volume is as deep as the capsule gets
+		const float RescueHeight = FMath::Max(Water.SurfaceHeight - DrownDepth,
+		                                      Water.BottomHeight + GetCapsuleComponent()->GetScaledCapsuleHalfHeight());
+		if (Location.Z <= RescueHeight)
+		{
+			// Back on dry ground, Landed recovers the stamina
+			GetCharacterMovement()->StopMovementImmediately();
+			SetActorLocation(LastDryLocation, false, nullptr, ETeleportType::TeleportPhysics);
+			GetCharacterMovement()->SetMovementMode(MOVE_Falling);
+			return;
+		}
+	}
+	else
+	{
+		// Float at the surface from the cached height instead of tracing the volume
+		const float TargetZ = Water.SurfaceHeight - SwimFloatDepth;
+		Offset.Z = FMath::FInterpTo(Location.Z, TargetZ, DeltaTime, 5.0f) - Location.Z;
+		GetCharacterMovement()->Velocity.Z = 0.0f;
+	}
+	AddActorWorldOffset(Offset, true);
+}
+
+void AMyCharacterBase::RideThermals(float DeltaTime)
+{
+	const UFireGridSubsystem* FireGrid = GetWorld()->GetSubsystem<UFireGridSubsystem>();
+	if (!FireGrid) return;
+
+	// Scale by the frame time, the same way AWindTunnel::Tick lifts the glider
+	const FVector Updraft = FireGrid->SampleUpdraft(GetActorLocation());
+	if (!Updraft.IsZero())
+	{
+		AddActorWorldOffset(Updraft * DeltaTime);
+	}
+}
+
+float AMyCharacterBase::GetNoiseLoudness() const
+{
+	if (GetVelocity().IsNearlyZero()) return 0.0f;
+
+	switch (CurrentMT)
+	{
+	case EMovementTypes::MM_SPRINTING:
+		return 1.0f;
+	case EMovementTypes::MM_SWIMMING:
+		return bSwimSprinting ? 0.6f : 0.25f;
+	case EMovementTypes::MM_CLIMBING:
+		return 0.15f;
+	case EMovementTypes::MM_GLIDING:
+		return 0.1f;
+	default:
+		return 0.35f;
+	}
+}
+
+AActor* AMyCharacterBase::SpawnRuneActor(const FTransform& Transform)
+{
+	if (!BootstrapData) return nullptr;
+
+	// Rune classes stream in with the PlayerBootstrap bundle, so this never loads synchronously
+	const TSoftClassPtr<AActor> RuneClass = BootstrapData->RuneActorClasses.FindRef(ActiveRune);
+	UClass* Class = RuneClass.Get();
+	if (!Class) return nullptr;
+
+	// Ice pillars and other rune geometry reach the navmesh through the capped tile rebuilds
+	if (URuneNavigationSubsystem* RuneNavigation = GetWorld()->GetSubsystem<URuneNavigationSubsystem>())
+	{
+		return RuneNavigation->SpawnRuneActor(Class, Transform, this);
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.Owner = this;
+	SpawnParams.Instigator = this;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+	return GetWorld()->SpawnActor<AActor>(Class, Transform, SpawnParams);
+}
+
 bool AMyCharacterBase::IsCharacterExhausted() const
 {
 	return CurrentMT == EMovementTypes::MM_EXHAUSTED;
@@ -359,14 +808,37 @@ void AMyCharacterBase::SetExhausted()
 	{
 		ResetToWalk();
 	}
+	// Exhausted on a wall or in the air, drop and recover after landing
+	else if (GetCharacterMovement()->MovementMode == MOVE_Flying)
+	{
+		GetCharacterMovement()->SetMovementMode(MOVE_Falling);
+	}
+	// Exhausted in water, sink until UpdateSwimming puts the character back on dry ground
+	else if (GetCharacterMovement()->MovementMode == MOVE_Swimming)
+	{
+		bSwimSprinting = false;
+		GetCharacterMovement()->Buoyancy = 0.0f;
+	}
 }
 
 void AMyCharacterBase::DrainStaminaTimer()
 {
 	if (CurrentStamina <= 0.0f)
 	{
+		if (Telemetry)
+		{
+			Telemetry->Record(Telemetry::EEvent::StaminaEmpty, static_cast<uint8>(CurrentMT));
+		}
 		LocomotionManager(EMovementTypes::MM_EXHAUSTED);
 	}
+	else if (CurrentMT == EMovementTypes::MM_CLIMBING)
+	{
+		// Hanging still on a wall is free
+		if (!GetVelocity().IsNearlyZero())
+		{
+			CurrentStamina = FMath::Clamp(CurrentStamina - ClimbStaminaDepletionAmount, 0.0f, MaxStamina);
+		}
+	}
 	else
 	{
 		CurrentStamina = FMath::Clamp(CurrentStamina - StaminaDepletionAmount, 0.0f, MaxStamina);
@@ -397,6 +869,10 @@ void AMyCharacterBase::RecoverStaminaTimer()
 	}
 	else
 	{
+		if (Telemetry)
+		{
+			Telemetry->Record(Telemetry::EEvent::StaminaFull);
+		}
 		ClearDrainRecoverStaminaTimer();
 		LocomotionManager(EMovementTypes::MM_WALKING);
 
@@ -426,6 +902,6 @@ void AMyCharacterBase::ClearDrainRecoverStaminaTimer()
 
 void AMyCharacterBase::AddGravityForFlying()
 {
-	LaunchCharacter(FVector(0.0f, 0.0f, -100.0f), false, true);
+	LaunchCharacter(FVector(0.0f, 0.0f, -GlideSinkSpeed), false, true);
 }
 #pragma endregion Stamina
@@ -0,0 +1,162 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Commandlets/CharacterMemoryReportCommandlet.h"
+
+#include "ZeldaLikeDemo.h"
+#include "Characters/MyCharacterBase.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/ArchiveCountMem.h"
+
+namespace
+{
+	/** Memory of a single object */
+	struct FObjectMemory
+	{
+		FString Name;
+		FString ClassName;
+		/** Size of the object itself */
+		int64 StructureBytes = 0;
+		/** Bytes reported by memory counting serialization, includes owned containers */
+		int64 CountedBytes = 0;
+		/** Exclusive resource size, such as render data */
+		int64 ResourceBytes = 0;
+
+		int64 GetTotal() const { return FMath::Max(StructureBytes, CountedBytes) + ResourceBytes; }
+	};
+
+	FObjectMemory MeasureObject(UObject* Object)
+	{
+		FArchiveCountMem CountMem(Object);
+
+		FObjectMemory Memory;
+		Memory.Name = Object->GetName();
+		Memory.ClassName = Object->GetClass()->GetName();
+		Memory.StructureBytes = Object->GetClass()->GetStructureSize();
+		Memory.CountedBytes = static_cast<int64>(CountMem.GetMax());
+		Memory.ResourceBytes = static_cast<int64>(Object->GetResourceSizeBytes(EResourceSizeMode::Exclusive));
+		return Memory;
+	}
+}
+
+UCharacterMemoryReportCommandlet::UCharacterMemoryReportCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UCharacterMemoryReportCommandlet::Main(const FString& Params)
+{
+	FString ClassPath;
+	FParse::Value(*Params, TEXT("Class="), ClassPath);
+
+	int32 Count = 1;
+	FParse::Value(*Params, TEXT("Count="), Count);
+	Count = FMath::Max(Count, 1);
+
+	FString CsvPath;
+	FParse::Value(*Params, TEXT("CSV="), CsvPath);
+
+	int64 Budget = 0;
+	FParse::Value(*Params, TEXT("Budget="), Budget);
+
+	UClass* CharacterClass = AMyCharacterBase::StaticClass();
+	if (!ClassPath.IsEmpty())
+	{
+		CharacterClass = StaticLoadClass(AMyCharacterBase::StaticClass(), nullptr, *ClassPath);
+		if (!CharacterClass)
+		{
+			UE_LOG(LogZeldaLikeDemo, Error, TEXT("Could not load character class %s"), *ClassPath);
+			return 1;
+		}
+	}
+
+	// Spawn into a throwaway game world, nothing runs BeginPlay so only construction cost is measured
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("CharacterMemoryReport"));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	World->InitializeActorsForPlay(FURL());
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	TArray<AMyCharacterBase*> Characters;
+	Characters.Reserve(Count);
+
+	const uint64 UsedBefore = FPlatformMemory::GetStats().UsedPhysical;
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const FVector Location(Index * 200.0f, 0.0f, 0.0f);
+		if (AMyCharacterBase* Character = World->SpawnActor<AMyCharacterBase>(CharacterClass, Location,
+		                                                                      FRotator::ZeroRotator, SpawnParams))
+		{
+			Characters.Add(Character);
+		}
+	}
+	const uint64 UsedAfter = FPlatformMemory::GetStats().UsedPhysical;
+
+	int32 Result = 0;
+	if (Characters.IsEmpty())
+	{
+		UE_LOG(LogZeldaLikeDemo, Error, TEXT("Could not spawn %s"), *CharacterClass->GetName());
+		Result = 1;
+	}
+	else
+	{
+		// Detail the first character, the others are identical
+		TArray<FObjectMemory> Rows;
+		Rows.Add(MeasureObject(Characters[0]));
+
+		TInlineComponentArray<UActorComponent*> Components(Characters[0]);
+		for (UActorComponent* Component : Components)
+		{
+			Rows.Add(MeasureObject(Component));
+		}
+
+		int64 Total = 0;
+		TArray<FString> CsvLines;
+		CsvLines.Add(TEXT("Name,Class,StructureBytes,CountedBytes,ResourceBytes,TotalBytes"));
+
+		UE_LOG(LogZeldaLikeDemo, Display, TEXT("Memory of one %s:"), *CharacterClass->GetName());
+		UE_LOG(LogZeldaLikeDemo, Display, TEXT("%-32s %-40s %10s %10s %10s %10s"), TEXT("Name"), TEXT("Class"),
+		       TEXT("Struct"), TEXT("Counted"), TEXT("Resource"), TEXT("Total"));
+		for (const FObjectMemory& Row : Rows)
+		{
+			Total += Row.GetTotal();
+			UE_LOG(LogZeldaLikeDemo, Display, TEXT("%-32s %-40s %10lld %10lld %10lld %10lld"), *Row.Name,
+			       *Row.ClassName, Row.StructureBytes, Row.CountedBytes, Row.ResourceBytes, Row.GetTotal());
+			CsvLines.Add(FString::Printf(TEXT("%s,%s,%lld,%lld,%lld,%lld"), *Row.Name, *Row.ClassName,
+			                             Row.StructureBytes, Row.CountedBytes, Row.ResourceBytes, Row.GetTotal()));
+		}
+		CsvLines.Add(FString::Printf(TEXT("Total,,,,,%lld"), Total));
+
+		const int64 PhysicalPerCharacter = (static_cast<int64>(UsedAfter) - static_cast<int64>(UsedBefore)) /
+			Characters.Num();
+		UE_LOG(LogZeldaLikeDemo, Display, TEXT("Total per character: %lld bytes in %d components"), Total,
+		       Components.Num());
+		UE_LOG(LogZeldaLikeDemo, Display, TEXT("Used physical memory per spawned character: %lld bytes over %d"),
+		       PhysicalPerCharacter, Characters.Num());
+
+		if (!CsvPath.IsEmpty() && !FFileHelper::SaveStringArrayToFile(CsvLines, *CsvPath))
+		{
+			UE_LOG(LogZeldaLikeDemo, Error, TEXT("Could not write %s"), *CsvPath);
+			Result = 1;
+		}
+
+		if (Budget > 0 && Total > Budget)
+		{
+			UE_LOG(LogZeldaLikeDemo, Error, TEXT("Character size %lld bytes exceeds the budget of %lld bytes"), Total,
+			       Budget);
+			Result = 1;
+		}
+	}
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	return Result;
+}
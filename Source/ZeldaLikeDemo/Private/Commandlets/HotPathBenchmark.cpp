@@ -0,0 +1,475 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Commandlets/HotPathBenchmark.h"
+
+#include "ZeldaLikeDemo.h"
+#include "Actors/WindTunnel.h"
+#include "Audio/WindSynth.h"
+#include "Animations/MyAnimInst.h"
+#include "Characters/MyCharacterBase.h"
+#include "Components/BoxComponent.h"
+#include "Commandlets/HotPathBenchmarkCommandlet.h"
+#include "Components/CapsuleComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/WorldSettings.h"
+#include "HAL/FileManager.h"
+#include "HAL/MemoryBase.h"
+#include "Misc/Paths.h"
+#include "Systems/ExplosionFieldSubsystem.h"
+#include "Systems/MeleeCombatSubsystem.h"
+#include "Telemetry/TelemetryLog.h"
+
+namespace
+{
+	/**
+	 * Forwards to the real allocator and counts allocations made on the thread that installed it.
+	 * Installed once and never removed, task graph and physics threads that loaded GMalloc may call into it at any
+	 * time, and swapping GMalloc back while they allocate is not safe.
+	 */
+	class FAllocationCountingMalloc final : public FMalloc
+	{
+	public:
+		static FAllocationCountingMalloc& Get()
+		{
+			static FAllocationCountingMalloc Instance;
+			return Instance;
+		}
+
+		/** Wraps GMalloc on first use and counts the allocations of the calling thread from then on */
+		void Install()
+		{
+			if (Inner) return;
+
+			check(IsInGameThread());
+			Inner = GMalloc;
+			ThreadId = FPlatformTLS::GetCurrentThreadId();
+			GMalloc = this;
+		}
+
+		void ResetNumAllocations() { NumAllocations = 0; }
+
+		int64 GetNumAllocations() const { return NumAllocations; }
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return Inner->TryMalloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			if (Count > 0) CountAllocation();
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			if (Count > 0) CountAllocation();
+			return Inner->TryRealloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override { Inner->Free(Original); }
+
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override
+		{
+			return Inner->QuantizeSize(Count, Alignment);
+		}
+
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override
+		{
+			return Inner->GetAllocationSize(Original, SizeOut);
+		}
+
+		virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+
+		virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override
+		{
+			Inner->ClearAndDisableTLSCachesOnCurrentThread();
+		}
+
+		virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+
+		virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+
+		virtual const TCHAR* GetDescriptiveName() override { return TEXT("AllocationCounting"); }
+
+	private:
+		void CountAllocation()
+		{
+			if (FPlatformTLS::GetCurrentThreadId() == ThreadId)
+			{
+				++NumAllocations;
+			}
+		}
+
+		FMalloc* Inner = nullptr;
+		uint32 ThreadId = 0;
+		int64 NumAllocations = 0;
+	};
+
+	/**
+	 * Calls Body warm-up times untimed, then Iterations times with time and allocations measured.
+	 * @param Body - Called with the iteration index
+	 */
+	template <typename FunctorType>
+	HotPathBenchmark::FResult RunBenchmark(FName Name, int64 Iterations, int32 WarmupIterations, FunctorType&& Body)
+	{
+		for (int32 Index = 0; Index < WarmupIterations; ++Index)
+		{
+			Body(Index);
+		}
+
+		FAllocationCountingMalloc& CountingMalloc = FAllocationCountingMalloc::Get();
+		CountingMalloc.ResetNumAllocations();
+
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		for (int64 Index = 0; Index < Iterations; ++Index)
+		{
+			Body(Index);
+		}
+		const uint64 EndCycles = FPlatformTime::Cycles64();
+
+		HotPathBenchmark::FResult Result;
+		Result.Name = Name;
+		Result.Iterations = Iterations;
+		Result.Nanoseconds = FPlatformTime::ToMilliseconds64(EndCycles - StartCycles) * 1.0e6 / Iterations;
+		Result.Allocations = static_cast<double>(CountingMalloc.GetNumAllocations()) / Iterations;
+		return Result;
+	}
+}
+
+const TArray<FName>& HotPathBenchmark::GetNames()
+{
+	static const TArray<FName> Names = {
+		TEXT("LocomotionManager"), TEXT("DrainStaminaTimer"), TEXT("RecoverStaminaTimer"), TEXT("Move_Triggered"),
+		TEXT("NativeUpdateAnimation"), TEXT("ClimbWall"), TEXT("WindTunnelTick"), TEXT("TelemetryRecord"),
+		TEXT("WindSynthBlock"), TEXT("MeleeCombat30"), TEXT("PhysicsStep500"), TEXT("ExplosionField500"),
+	};
+	return Names;
+}
+
+bool HotPathBenchmark::Run(const FString& Filter, int64 Iterations, TArray<FResult>& OutResults)
+{
+	const int32 WarmupIterations = GetDefault<UHotPathBenchmarkCommandlet>()->WarmupIterations;
+	Iterations = FMath::Max<int64>(Iterations, 1);
+	auto ShouldRun = [&Filter](const TCHAR* Name)
+	{
+		return Filter.IsEmpty() || Filter == Name;
+	};
+
+	// Same throwaway world as the memory report, nothing runs BeginPlay
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("HotPathBenchmark"));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	World->InitializeActorsForPlay(FURL());
+
+	// APawn::ShouldTakeDamage needs an authority game mode, which the world creates through a game instance
+	World->SetGameInstance(NewObject<UGameInstance>(GEngine));
+	World->GetWorldSettings()->DefaultGameMode = AGameModeBase::StaticClass();
+	World->SetGameMode(FURL());
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	AMyCharacterBase* Character = World->SpawnActor<AMyCharacterBase>(
+		AMyCharacterBase::StaticClass(), FVector::ZeroVector, FRotator::ZeroRotator, SpawnParams);
+	AWindTunnel* WindTunnel = World->SpawnActor<AWindTunnel>(
+		AWindTunnel::StaticClass(), FVector::ZeroVector, FRotator::ZeroRotator, SpawnParams);
+	APlayerController* Controller = World->SpawnActor<APlayerController>(SpawnParams);
+	if (!Character || !WindTunnel || !Controller)
+	{
+		UE_LOG(LogZeldaLikeDemo, Error, TEXT("Could not spawn the benchmark actors"));
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+		return false;
+	}
+
+	// Move_Triggered returns early without a controller
+	Character->PossessedBy(Controller);
+
+	// Nothing runs BeginPlay, so what it sets up is either set here or missing from the rows:
+	// - Stamina and health start full, as after BeginPlay and the bootstrap callback.
+	// - Telemetry is null, LocomotionManager and the stamina timers skip their records. TelemetryRecord times one.
+	// - UInputLatencyComponent has no owner, Move_Triggered and LocomotionManager skip tagging the input, which
+	//   only reads the clock and the movement state and is left untimed.
+	// - The wind tunnel has telemetry id 0, which WindTunnelTick never reads.
+	Character->CurrentStamina = Character->MaxStamina;
+	Character->CurrentHealth = Character->MaxHealth;
+	Character->LastDryLocation = Character->GetActorLocation();
+
+	UMyAnimInst* AnimInst = NewObject<UMyAnimInst>(Character->GetMesh());
+	AnimInst->NativeInitializeAnimation();
+
+	FAllocationCountingMalloc::Get().Install();
+
+	auto Run = [&](const TCHAR* Name, auto&& Body, int64 MaxIterations = MAX_int64)
+	{
+		checkf(GetNames().Contains(Name), TEXT("%s is missing from HotPathBenchmark::GetNames"), Name);
+		if (!ShouldRun(Name)) return;
+		const int64 RowIterations = FMath::Min(Iterations, MaxIterations);
+		const int32 RowWarmup = static_cast<int32>(FMath::Min<int64>(WarmupIterations, RowIterations));
+		OutResults.Add(RunBenchmark(Name, RowIterations, RowWarmup, Body));
+	};
+
+	Run(TEXT("LocomotionManager"), [Character](int64 Index)
+	{
+		Character->LocomotionManager(Index & 1 ? EMovementTypes::MM_SPRINTING : EMovementTypes::MM_WALKING);
+	});
+
+	Run(TEXT("DrainStaminaTimer"), [Character](int64 Index)
+	{
+		Character->CurrentMT = EMovementTypes::MM_SPRINTING;
+		Character->CurrentStamina = Character->MaxStamina;
+		Character->DrainStaminaTimer();
+	});
+
+	Run(TEXT("RecoverStaminaTimer"), [Character](int64 Index)
+	{
+		Character->CurrentStamina = Character->MaxStamina * 0.5f;
+		Character->RecoverStaminaTimer();
+	});
+
+	Run(TEXT("Move_Triggered"), [Character](int64 Index)
+	{
+		Character->Move_Triggered(FInputActionValue(FVector2D(Index & 1 ? 1.0 : 0.5, 1.0)));
+	});
+
+	Run(TEXT("NativeUpdateAnimation"), [AnimInst](int64 Index)
+	{
+		AnimInst->NativeUpdateAnimation(1.0f / 60.0f);
+	});
+
+	// Climbing in circles on a wall far from the other rows, at climbing speed. Traces per frame are compared with a
+	// naive probe tracing the wall, the ledge and both sides every frame, 4 per frame
+	const FVector WallCenter(40000.0, 0.0, 1000.0);
+	AActor* Wall = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform(WallCenter), SpawnParams);
+	UBoxComponent* WallBox = NewObject<UBoxComponent>(Wall);
+	WallBox->SetBoxExtent(FVector(50.0, 1000.0, 1000.0));
+	WallBox->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+	WallBox->SetWorldLocation(WallCenter);
+	Wall->SetRootComponent(WallBox);
+	WallBox->RegisterComponent();
+
+	const FVector WallNormal(-1.0, 0.0, 0.0);
+	const FVector WallPoint = WallCenter + WallNormal * 50.0;
+	const FVector ClimbCenter = WallPoint + WallNormal *
+		(Character->GetCapsuleComponent()->GetScaledCapsuleRadius() + Character->ClimbWallGap);
+	Character->SetActorLocation(ClimbCenter);
+	Character->Velocity_X = 0.0f;
+	Character->Velocity_Y = 0.0f;
+	Character->ClimbSurface.Anchor(WallPoint, WallNormal);
+	Character->LocomotionManager(EMovementTypes::MM_CLIMBING);
+
+	const uint64 ClimbTracesBefore = Character->ClimbSurface.GetNumTraces();
+	const uint64 ClimbFramesBefore = Character->NumClimbFrames;
+	Run(TEXT("ClimbWall"), [Character, ClimbCenter](int64 Index)
+	{
+		constexpr double ClimbRadius = 300.0;
+		const double Angle = Index * Character->ClimbSpeed / 60.0 / ClimbRadius;
+		Character->SetActorLocation(ClimbCenter + FVector(0.0, FMath::Cos(Angle), FMath::Sin(Angle)) * ClimbRadius);
+		Character->UpdateClimbing();
+	});
+	const uint64 ClimbFrames = Character->NumClimbFrames - ClimbFramesBefore;
+	if (ShouldRun(TEXT("ClimbWall")) && ClimbFrames > 0)
+	{
+		OutResults.Last().Traces =
+			static_cast<double>(Character->ClimbSurface.GetNumTraces() - ClimbTracesBefore) / ClimbFrames;
+	}
+	Character->LocomotionManager(EMovementTypes::MM_WALKING);
+	// Back inside the wind tunnel for the next row
+	Character->SetActorLocation(FVector::ZeroVector);
+
+	// A gliding player in the tunnel, the path that moves the character. The tunnel is tall enough for the lift
+	// between two resets, a player lifted out of it would end the overlap and skip the path
+	WindTunnel->Box->SetBoxExtent(FVector(200.0, 200.0, 3000.0));
+	WindTunnel->PlayerRef = Character;
+	Character->CurrentMT = EMovementTypes::MM_GLIDING;
+	Run(TEXT("WindTunnelTick"), [WindTunnel, Character](int64 Index)
+	{
+		if ((Index & 255) == 0)
+		{
+			Character->SetActorLocation(FVector::ZeroVector);
+		}
+		WindTunnel->Tick(1.0f / 60.0f);
+	});
+
+	// Same work as UTelemetrySubsystem::Record, which needs a game instance
+	FTelemetryLog TelemetryLog;
+	const FString TelemetryPath = FPaths::ProjectSavedDir() / TEXT("Telemetry") / TEXT("HotPathBenchmark.zlt");
+	const uint32 TelemetryCapacity = static_cast<uint32>(FMath::Min<int64>(Iterations + WarmupIterations, MAX_uint32));
+	if (ShouldRun(TEXT("TelemetryRecord")) &&
+		TelemetryLog.Open(TelemetryPath, TelemetryCapacity, FDateTime::UtcNow().ToUnixTimestamp()))
+	{
+		Run(TEXT("TelemetryRecord"), [&TelemetryLog](int64 Index)
+		{
+			Telemetry::FRecord Record;
+			Record.Time = FPlatformTime::Seconds();
+			Record.Frame = static_cast<uint32>(GFrameCounter);
+			Record.Event = Telemetry::EEvent::LocomotionChanged;
+			Record.Arg0 = static_cast<uint8>(EMovementTypes::MM_WALKING);
+			Record.Arg1 = static_cast<uint8>(EMovementTypes::MM_SPRINTING);
+			Record.Reserved = 0;
+			Record.Value = 100.0f;
+			Record.Subject = 0;
+			TelemetryLog.Append(Record);
+		});
+		TelemetryLog.Close();
+		IFileManager::Get().Delete(*TelemetryPath);
+	}
+
+	// One audio render thread block with every voice audible, no audio device needed
+	constexpr int32 WindSynthBlockSize = 512;
+	FWindSynth WindSynth;
+	WindSynth.Init(48000.0f, WindSynthBlockSize);
+	WindSynth.SetParams({1.0f, 1.0f, 1.0f});
+	TArray<float> WindSynthBlock;
+	WindSynthBlock.SetNumZeroed(WindSynthBlockSize);
+	Run(TEXT("WindSynthBlock"), [&WindSynth, &WindSynthBlock](int64 Index)
+	{
+		WindSynth.Generate(WindSynthBlock.GetData(), WindSynthBlock.Num());
+	});
+
+	// A crowd brawl, every fighter swinging into its neighbours. The meshes have no weapon sockets and sweep a sphere
+	// at the mesh origin, wide enough to reach the neighbours' capsules. Swings restart every 16 frames so every
+	// swing hits again, defeated fighters stand back up where they are with full health
+	constexpr int32 NumFighters = 30;
+	UMeleeCombatSubsystem* MeleeCombat = World->GetSubsystem<UMeleeCombatSubsystem>();
+	TArray<AMyCharacterBase*> Fighters;
+	for (int32 Index = 0; MeleeCombat && ShouldRun(TEXT("MeleeCombat30")) && Index < NumFighters; ++Index)
+	{
+		const FVector Location(5000.0 + (Index % 6) * 100.0, (Index / 6) * 100.0, 0.0);
+		if (AMyCharacterBase* Fighter = World->SpawnActor<AMyCharacterBase>(
+			AMyCharacterBase::StaticClass(), Location, FRotator::ZeroRotator, SpawnParams))
+		{
+			Fighter->CurrentHealth = Fighter->MaxHealth;
+			Fighter->LastDryLocation = Location;
+			Fighters.Add(Fighter);
+		}
+	}
+
+	if (Fighters.Num() == NumFighters)
+	{
+		FMeleeAttackParams Attack;
+		Attack.Radius = 80.0f;
+		Run(TEXT("MeleeCombat30"), [World, MeleeCombat, &Fighters, &Attack](int64 Index)
+		{
+			if ((Index & 15) == 0)
+			{
+				for (AMyCharacterBase* Fighter : Fighters)
+				{
+					MeleeCombat->EndSwing(Fighter->GetMesh(), World);
+					MeleeCombat->BeginSwing(Fighter->GetMesh(), World, Attack);
+				}
+			}
+			MeleeCombat->Tick(1.0f / 60.0f);
+		});
+	}
+
+	// The physics rows tick the whole world, open swings and the fighters' movement would be timed with them
+	for (AMyCharacterBase* Fighter : Fighters)
+	{
+		MeleeCombat->EndSwing(Fighter->GetMesh(), World);
+		Fighter->Destroy();
+	}
+	Fighters.Reset();
+
+	// A bomb in a crate pile: 500 crates in the blast and 2000 elsewhere in the level that the physics pass must not
+	// visit. PhysicsStep500 is the same world step without a blast, the gap between the two rows is the blast
+	UExplosionFieldSubsystem* ExplosionField = World->GetSubsystem<UExplosionFieldSubsystem>();
+	if (ExplosionField && (ShouldRun(TEXT("PhysicsStep500")) || ShouldRun(TEXT("ExplosionField500"))))
+	{
+		// Registers the physics callback, the world never begins play
+		ExplosionField->OnWorldBeginPlay(*World);
+
+		auto SpawnCrate = [World, &SpawnParams](const FVector& Location)
+		{
+			AActor* Crate = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform(Location), SpawnParams);
+			UBoxComponent* Box = NewObject<UBoxComponent>(Crate);
+			Box->SetBoxExtent(FVector(20.0));
+			Box->SetCollisionProfileName(UCollisionProfile::PhysicsActor_ProfileName);
+			Box->SetWorldLocation(Location);
+			Crate->SetRootComponent(Box);
+			Box->RegisterComponent();
+			// Floating and spaced apart, so the solver has no contacts to resolve
+			Box->SetEnableGravity(false);
+			Box->SetLinearDamping(10.0f);
+			Box->SetSimulatePhysics(true);
+		};
+
+		const FVector BlastOrigin(-20000.0, 0.0, 0.0);
+		for (int32 Index = 0; Index < 500; ++Index)
+		{
+			SpawnCrate(BlastOrigin + FVector(Index % 10 - 4.5, Index / 10 % 10 - 4.5, Index / 100 - 2.0) * 80.0);
+		}
+		for (int32 Index = 0; Index < 2000; ++Index)
+		{
+			SpawnCrate(BlastOrigin + FVector(-3000.0 - (Index % 50) * 80.0, (Index / 50) * 80.0, 0.0));
+		}
+
+		FExplosionParams Blast;
+		Blast.Radius = 600.0f;
+		constexpr int64 PhysicsStepIterations = 2000;
+		Run(TEXT("PhysicsStep500"), [World](int64 Index)
+		{
+			World->Tick(LEVELTICK_All, 1.0f / 60.0f);
+		}, PhysicsStepIterations);
+
+		Run(TEXT("ExplosionField500"), [World, ExplosionField, &Blast, BlastOrigin](int64 Index)
+		{
+			// Pushing out and pulling back in turns keeps the pile in the blast over the run
+			Blast.Impulse = Index & 1 ? -100.0f : 100.0f;
+			ExplosionField->Detonate(BlastOrigin, Blast);
+			World->Tick(LEVELTICK_All, 1.0f / 60.0f);
+		}, PhysicsStepIterations);
+	}
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	return true;
+}
+
+const FHotPathBudget* HotPathBenchmark::FindBudget(FName Name)
+{
+	return GetDefault<UHotPathBenchmarkCommandlet>()->Budgets.FindByPredicate([Name](const FHotPathBudget& Entry)
+	{
+		return Entry.Name == Name;
+	});
+}
+
+bool HotPathBenchmark::CheckBudget(const FResult& Result, TArray<FString>& OutErrors)
+{
+	const FHotPathBudget* Budget = FindBudget(Result.Name);
+	if (!Budget) return true;
+
+	const int32 NumErrors = OutErrors.Num();
+	if (Budget->MaxNanoseconds > 0.0 && Result.Nanoseconds > Budget->MaxNanoseconds)
+	{
+		OutErrors.Add(FString::Printf(TEXT("%s takes %.1f ns per call, over the budget of %.1f ns"),
+		                              *Result.Name.ToString(), Result.Nanoseconds, Budget->MaxNanoseconds));
+	}
+	if (Budget->MaxAllocations >= 0.0 && Result.Allocations > Budget->MaxAllocations)
+	{
+		OutErrors.Add(FString::Printf(TEXT("%s makes %.3f allocations per call, over the budget of %.3f"),
+		                              *Result.Name.ToString(), Result.Allocations, Budget->MaxAllocations));
+	}
+	if (Budget->MaxTraces >= 0.0 && (Result.Traces < 0.0 || Result.Traces > Budget->MaxTraces))
+	{
+		OutErrors.Add(FString::Printf(TEXT("%s makes %.3f traces per call, over the budget of %.3f"),
+		                              *Result.Name.ToString(), Result.Traces, Budget->MaxTraces));
+	}
+	return OutErrors.Num() == NumErrors;
+}
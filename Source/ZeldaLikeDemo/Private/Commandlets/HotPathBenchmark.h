@@ -0,0 +1,46 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FHotPathBudget;
+
+/**
+ * Hot path benchmarks shared by UHotPathBenchmarkCommandlet and the ZeldaLikeDemo.Perf.HotPath automation spec.
+ * Budgets come from the commandlet's section in DefaultGame.ini either way.
+ */
+namespace HotPathBenchmark
+{
+	struct FResult
+	{
+		FName Name;
+		int64 Iterations = 0;
+		double Nanoseconds = 0.0;
+		double Allocations = 0.0;
+		/** Scene query traces per call, negative for rows that do not count them */
+		double Traces = -1.0;
+	};
+
+	/** Names of all benchmarks, in the order they run */
+	const TArray<FName>& GetNames();
+
+	/**
+	 * Sets up a throwaway world and runs the benchmarks matching a filter in it.
+	 * @param Filter - Name of the only benchmark to run, all of them when empty
+	 * @param Iterations - Timed calls per benchmark, rows that step the physics scene cap their own
+	 * @param OutResults - One result per benchmark that ran
+	 * @return Whether the world could be set up
+	 */
+	bool Run(const FString& Filter, int64 Iterations, TArray<FResult>& OutResults);
+
+	/** Gets the budget of a benchmark, null when it only reports */
+	const FHotPathBudget* FindBudget(FName Name);
+
+	/**
+	 * Compares a result with its budget.
+	 * @param OutErrors - One message per exceeded limit
+	 * @return Whether the result is within its budget
+	 */
+	bool CheckBudget(const FResult& Result, TArray<FString>& OutErrors);
+}
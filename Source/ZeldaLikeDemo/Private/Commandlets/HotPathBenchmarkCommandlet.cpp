@@ -0,0 +1,81 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Commandlets/HotPathBenchmarkCommandlet.h"
+
+#include "ZeldaLikeDemo.h"
+#include "Commandlets/HotPathBenchmark.h"
+#include "Misc/FileHelper.h"
+
+UHotPathBenchmarkCommandlet::UHotPathBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UHotPathBenchmarkCommandlet::Main(const FString& Params)
+{
+	int64 RunIterations = Iterations;
+	FParse::Value(*Params, TEXT("Iterations="), RunIterations);
+
+	FString Filter;
+	FParse::Value(*Params, TEXT("Bench="), Filter);
+
+	FString CsvPath;
+	FParse::Value(*Params, TEXT("CSV="), CsvPath);
+
+	TArray<HotPathBenchmark::FResult> Results;
+	if (!HotPathBenchmark::Run(Filter, RunIterations, Results))
+	{
+		UE_LOG(LogZeldaLikeDemo, Error, TEXT("Could not spawn the benchmark actors"));
+		return 1;
+	}
+
+	int32 Result = 0;
+	TArray<FString> CsvLines;
+	CsvLines.Add(TEXT("Name,Iterations,Nanoseconds,Allocations,Traces,MaxNanoseconds,MaxAllocations,MaxTraces,Passed"));
+
+	UE_LOG(LogZeldaLikeDemo, Display, TEXT("%-24s %12s %12s %12s %12s %12s %12s"), TEXT("Benchmark"), TEXT("ns/call"),
+	       TEXT("Budget ns"), TEXT("allocs/call"), TEXT("Budget"), TEXT("traces/call"), TEXT("Budget"));
+	for (const HotPathBenchmark::FResult& Benchmark : Results)
+	{
+		const FHotPathBudget* Budget = HotPathBenchmark::FindBudget(Benchmark.Name);
+		const double MaxNanoseconds = Budget ? Budget->MaxNanoseconds : 0.0;
+		const double MaxAllocations = Budget ? Budget->MaxAllocations : -1.0;
+		const double MaxTraces = Budget ? Budget->MaxTraces : -1.0;
+
+		UE_LOG(LogZeldaLikeDemo, Display, TEXT("%-24s %12.1f %12.1f %12.3f %12.3f %12.3f %12.3f"),
+		       *Benchmark.Name.ToString(), Benchmark.Nanoseconds, MaxNanoseconds, Benchmark.Allocations, MaxAllocations,
+		       Benchmark.Traces, MaxTraces);
+
+		TArray<FString> Errors;
+		const bool bPassed = HotPathBenchmark::CheckBudget(Benchmark, Errors);
+		for (const FString& Error : Errors)
+		{
+			UE_LOG(LogZeldaLikeDemo, Error, TEXT("%s"), *Error);
+		}
+		if (!bPassed)
+		{
+			Result = 1;
+		}
+
+		CsvLines.Add(FString::Printf(TEXT("%s,%lld,%.1f,%.3f,%.3f,%.1f,%.3f,%.3f,%d"), *Benchmark.Name.ToString(),
+		                             Benchmark.Iterations, Benchmark.Nanoseconds, Benchmark.Allocations,
+		                             Benchmark.Traces, MaxNanoseconds, MaxAllocations, MaxTraces, bPassed));
+	}
+
+	if (Results.IsEmpty())
+	{
+		UE_LOG(LogZeldaLikeDemo, Error, TEXT("No benchmark matches %s"), *Filter);
+		Result = 1;
+	}
+
+	if (!CsvPath.IsEmpty() && !FFileHelper::SaveStringArrayToFile(CsvLines, *CsvPath))
+	{
+		UE_LOG(LogZeldaLikeDemo, Error, TEXT("Could not write %s"), *CsvPath);
+		Result = 1;
+	}
+
+	return Result;
+}
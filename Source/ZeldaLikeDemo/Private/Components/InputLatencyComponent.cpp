@@ -0,0 +1,264 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Components/InputLatencyComponent.h"
+
+#include "ZeldaLikeDemo.h"
+#include "Characters/MyCharacterBase.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Move To Motion (ms)"), STAT_MoveToMotion, STATGROUP_ZeldaLikeDemo);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Move To Animation (ms)"), STAT_MoveToAnimation, STATGROUP_ZeldaLikeDemo);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Sprint To Motion (ms)"), STAT_SprintToMotion, STATGROUP_ZeldaLikeDemo);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Sprint To Animation (ms)"), STAT_SprintToAnimation, STATGROUP_ZeldaLikeDemo);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("JumpGlide To Motion (ms)"), STAT_JumpGlideToMotion, STATGROUP_ZeldaLikeDemo);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("JumpGlide To Animation (ms)"), STAT_JumpGlideToAnimation,
+                               STATGROUP_ZeldaLikeDemo);
+
+CSV_DEFINE_CATEGORY(InputLatency, true);
+
+UInputLatencyComponent::UInputLatencyComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	// Run after the movement component has consumed this frame's input
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+	// Only ticks while an input is waiting for its motion
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+}
+
+void UInputLatencyComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	OwnerCharacter = Cast<AMyCharacterBase>(GetOwner());
+}
+
+void UInputLatencyComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	DumpHistograms();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UInputLatencyComponent::TagInput(ELatencyInputs Input)
+{
+	if (!OwnerCharacter) return;
+
+	FTrackedInput& Entry = Tracked[static_cast<int32>(Input)];
+	// Keep the earliest press if the previous one has not shown up yet
+	if (Entry.bWaitingMotion || Entry.bWaitingAnimation) return;
+
+	const UCharacterMovementComponent* MoveComp = OwnerCharacter->GetCharacterMovement();
+
+	Entry.InputCycles = FPlatformTime::Cycles64();
+	Entry.InputFrame = GFrameCounter;
+	Entry.PreviousMaxSpeed = MoveComp->GetMaxSpeed();
+	Entry.PreviousMode = MoveComp->MovementMode;
+	Entry.bWasFalling = MoveComp->IsFalling();
+	Entry.bWasGliding = OwnerCharacter->CurrentMT == EMovementTypes::MM_GLIDING;
+	Entry.bWaitingMotion = true;
+	Entry.bWaitingAnimation = true;
+
+	SetComponentTickEnabled(true);
+}
+
+void UInputLatencyComponent::TickComponent(float DeltaTime, ELevelTick TickType,
+                                           FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	if (!OwnerCharacter) return;
+
+	const UCharacterMovementComponent* MoveComp = OwnerCharacter->GetCharacterMovement();
+
+	bool bAnyWaiting = false;
+	for (int32 Index = 0; Index < UE_ARRAY_COUNT(Tracked); ++Index)
+	{
+		FTrackedInput& Entry = Tracked[Index];
+		if (!Entry.bWaitingMotion && !Entry.bWaitingAnimation) continue;
+
+		if (GFrameCounter - Entry.InputFrame > static_cast<uint64>(MaxTrackedFrames))
+		{
+			Entry.bWaitingMotion = false;
+			Entry.bWaitingAnimation = false;
+			continue;
+		}
+
+		if (Entry.bWaitingMotion)
+		{
+			bool bApplied = false;
+			switch (static_cast<ELatencyInputs>(Index))
+			{
+			case ELatencyInputs::LI_MOVE:
+				bApplied = !MoveComp->GetCurrentAcceleration().IsNearlyZero();
+				break;
+			case ELatencyInputs::LI_SPRINT:
+				bApplied = OwnerCharacter->GetVelocity().Size2D() > Entry.PreviousMaxSpeed + 1.0f;
+				break;
+			case ELatencyInputs::LI_JUMPGLIDE:
+				bApplied = MoveComp->MovementMode != Entry.PreviousMode;
+				break;
+			default:
+				break;
+			}
+
+			if (bApplied)
+			{
+				Entry.bWaitingMotion = false;
+				RecordStage(static_cast<ELatencyInputs>(Index), false, Entry.InputCycles, Entry.InputFrame);
+			}
+		}
+
+		bAnyWaiting |= Entry.bWaitingMotion || Entry.bWaitingAnimation;
+	}
+
+	if (!bAnyWaiting)
+	{
+		SetComponentTickEnabled(false);
+	}
+}
+
+void UInputLatencyComponent::ObserveAnimation(float GroundSpeed, bool bShouldMove, bool bIsFalling, bool bIsGliding)
+{
+	for (int32 Index = 0; Index < UE_ARRAY_COUNT(Tracked); ++Index)
+	{
+		FTrackedInput& Entry = Tracked[Index];
+		if (!Entry.bWaitingAnimation) continue;
+
+		bool bReached = false;
+		switch (static_cast<ELatencyInputs>(Index))
+		{
+		case ELatencyInputs::LI_MOVE:
+			bReached = bShouldMove;
+			break;
+		case ELatencyInputs::LI_SPRINT:
+			bReached = GroundSpeed > Entry.PreviousMaxSpeed + 1.0f;
+			break;
+		case ELatencyInputs::LI_JUMPGLIDE:
+			bReached = bIsFalling != Entry.bWasFalling || bIsGliding != Entry.bWasGliding;
+			break;
+		default:
+			break;
+		}
+
+		if (bReached)
+		{
+			Entry.bWaitingAnimation = false;
+			RecordStage(static_cast<ELatencyInputs>(Index), true, Entry.InputCycles, Entry.InputFrame);
+		}
+	}
+}
+
+void UInputLatencyComponent::RecordStage(ELatencyInputs Input, bool bAnimationStage, uint64 StartCycles,
+                                         uint64 StartFrame)
+{
+	const double Ms = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+	const uint64 Frames = GFrameCounter - StartFrame;
+	const int32 Index = static_cast<int32>(Input);
+
+	if (bAnimationStage)
+	{
+		AnimationHistograms[Index].Add(Ms, Frames);
+	}
+	else
+	{
+		MotionHistograms[Index].Add(Ms, Frames);
+	}
+
+	switch (Input)
+	{
+	case ELatencyInputs::LI_MOVE:
+		if (bAnimationStage)
+		{
+			SET_FLOAT_STAT(STAT_MoveToAnimation, Ms);
+			CSV_CUSTOM_STAT(InputLatency, MoveToAnimationMs, Ms, ECsvCustomStatOp::Max);
+		}
+		else
+		{
+			SET_FLOAT_STAT(STAT_MoveToMotion, Ms);
+			CSV_CUSTOM_STAT(InputLatency, MoveToMotionMs, Ms, ECsvCustomStatOp::Max);
+		}
+		break;
+	case ELatencyInputs::LI_SPRINT:
+		if (bAnimationStage)
+		{
+			SET_FLOAT_STAT(STAT_SprintToAnimation, Ms);
+			CSV_CUSTOM_STAT(InputLatency, SprintToAnimationMs, Ms, ECsvCustomStatOp::Max);
+		}
+		else
+		{
+			SET_FLOAT_STAT(STAT_SprintToMotion, Ms);
+			CSV_CUSTOM_STAT(InputLatency, SprintToMotionMs, Ms, ECsvCustomStatOp::Max);
+		}
+		break;
+	case ELatencyInputs::LI_JUMPGLIDE:
+		if (bAnimationStage)
+		{
+			SET_FLOAT_STAT(STAT_JumpGlideToAnimation, Ms);
+			CSV_CUSTOM_STAT(InputLatency, JumpGlideToAnimationMs, Ms, ECsvCustomStatOp::Max);
+		}
+		else
+		{
+			SET_FLOAT_STAT(STAT_JumpGlideToMotion, Ms);
+			CSV_CUSTOM_STAT(InputLatency, JumpGlideToMotionMs, Ms, ECsvCustomStatOp::Max);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+void UInputLatencyComponent::DumpHistograms() const
+{
+	const UEnum* InputEnum = StaticEnum<ELatencyInputs>();
+
+	FString Header = TEXT("Input,Stage,Samples,AverageMs,MaxMs,AverageFrames");
+	for (int32 Bucket = 0; Bucket < Debug::FLatencyHistogram::NumBuckets; ++Bucket)
+	{
+		Header += TEXT(",") + Debug::FLatencyHistogram::GetBucketLabel(Bucket);
+	}
+
+	TArray<FString> Lines;
+	Lines.Add(Header);
+
+	for (int32 Index = 0; Index < UE_ARRAY_COUNT(Tracked); ++Index)
+	{
+		for (const bool bAnimationStage : {false, true})
+		{
+			const Debug::FLatencyHistogram& Histogram = bAnimationStage
+				                                            ? AnimationHistograms[Index]
+				                                            : MotionHistograms[Index];
+			if (Histogram.NumSamples == 0) continue;
+
+			const FString InputName = InputEnum->GetNameStringByIndex(Index);
+			const TCHAR* StageName = bAnimationStage ? TEXT("Animation") : TEXT("Motion");
+			UE_LOG(LogZeldaLikeDemo, Display, TEXT("Input latency %s to %s: %u samples, avg %.2f ms, max %.2f ms, avg %.2f frames"),
+			       *InputName, StageName, Histogram.NumSamples, Histogram.GetAverageMs(), Histogram.MaxMs,
+			       Histogram.GetAverageFrames());
+
+			FString Line = FString::Printf(TEXT("%s,%s,%u,%.3f,%.3f,%.3f"), *InputName, StageName,
+			                               Histogram.NumSamples, Histogram.GetAverageMs(), Histogram.MaxMs,
+			                               Histogram.GetAverageFrames());
+			for (const uint32 Count : Histogram.Counts)
+			{
+				Line += FString::Printf(TEXT(",%u"), Count);
+			}
+			Lines.Add(Line);
+		}
+	}
+
+	// Header only, nothing was measured
+	if (Lines.Num() == 1) return;
+
+	const FString Directory = FPaths::ProfilingDir() / TEXT("InputLatency");
+	IFileManager::Get().MakeDirectory(*Directory, true);
+	const FString FilePath = Directory / FString::Printf(
+		TEXT("InputLatency-%s.csv"), *FDateTime::Now().ToString(TEXT("%Y%m%d-%H%M%S")));
+	if (FFileHelper::SaveStringArrayToFile(Lines, *FilePath))
+	{
+		UE_LOG(LogZeldaLikeDemo, Display, TEXT("Input latency histograms written to %s"), *FilePath);
+	}
+}
@@ -0,0 +1,64 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Components/StreamingLookAheadComponent.h"
+
+#include "WorldPartition/WorldPartitionSubsystem.h"
+
+UStreamingLookAheadComponent::UStreamingLookAheadComponent()
+{
+	// Queried by the streaming update, nothing to tick
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UStreamingLookAheadComponent::OnRegister()
+{
+	Super::OnRegister();
+
+	SourceName = *FString::Printf(TEXT("%s_LookAhead"), *GetOwner()->GetName());
+
+	UWorld* World = GetWorld();
+	if (!World || !World->IsGameWorld()) return;
+
+	if (UWorldPartitionSubsystem* WorldPartition = World->GetSubsystem<UWorldPartitionSubsystem>())
+	{
+		WorldPartition->RegisterStreamingSourceProvider(this);
+	}
+}
+
+void UStreamingLookAheadComponent::OnUnregister()
+{
+	UWorld* World = GetWorld();
+	if (UWorldPartitionSubsystem* WorldPartition = World ? World->GetSubsystem<UWorldPartitionSubsystem>() : nullptr)
+	{
+		WorldPartition->UnregisterStreamingSourceProvider(this);
+	}
+
+	Super::OnUnregister();
+}
+
+bool UStreamingLookAheadComponent::GetStreamingSources(TArray<FWorldPartitionStreamingSource>& OutStreamingSources) const
+{
+	const AActor* Owner = GetOwner();
+	if (!Owner) return false;
+
+	const FVector Velocity = VelocityOverride.IsZero() ? Owner->GetVelocity() : VelocityOverride;
+	const double Speed = Velocity.Size();
+	if (Speed < MinSpeed) return false;
+
+	const FVector Direction = Velocity / Speed;
+	const double Distance = FMath::Min(Speed * LookAheadSeconds, static_cast<double>(MaxDistance));
+
+	FStreamingSourceShape Shape;
+	Shape.bUseGridLoadingRange = true;
+	Shape.LoadingRangeScale = LoadingRangeScale;
+
+	FWorldPartitionStreamingSource& Source = OutStreamingSources.AddDefaulted_GetRef();
+	Source.Name = SourceName;
+	Source.Location = Owner->GetActorLocation() + Direction * Distance;
+	Source.Rotation = Direction.Rotation();
+	Source.TargetState = EStreamingSourceTargetState::Activated;
+	Source.Priority = EStreamingSourcePriority::High;
+	Source.Shapes.Add(Shape);
+	return true;
+}
@@ -0,0 +1,336 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Components/TrajectoryPredictionComponent.h"
+
+#include "ZeldaLikeDemo.h"
+#include "Characters/MyCharacterBase.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/DecalComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Systems/WaterQuerySubsystem.h"
+#include "Systems/WindFieldSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Trajectory Prediction"), STAT_TrajectoryPrediction, STATGROUP_ZeldaLikeDemo);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Trajectory Sweeps"), STAT_TrajectorySweeps, STATGROUP_ZeldaLikeDemo);
+
+namespace
+{
+	/** Samples integrated per SIMD batch, and covered by a single coarse sweep */
+	constexpr int32 BatchSize = 4;
+
+	/**
+	 * Evaluates one axis of P + V * t + A * t^2 / 2 for the four sample times of a batch.
+	 * @param T - Sample times of the batch
+	 * @param HalfT2 - Half of the squared sample times
+	 */
+	FORCEINLINE VectorRegister4Float IntegrateAxis(float P, float V, float A, const VectorRegister4Float& T,
+	                                               const VectorRegister4Float& HalfT2)
+	{
+		const VectorRegister4Float Linear = VectorMultiplyAdd(VectorSetFloat1(V), T, VectorSetFloat1(P));
+		return VectorMultiplyAdd(VectorSetFloat1(A), HalfT2, Linear);
+	}
+}
+
+UTrajectoryPredictionComponent::UTrajectoryPredictionComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	// Predict from where movement has put the character this frame
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+}
+
+void UTrajectoryPredictionComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	OwnerCharacter = Cast<AMyCharacterBase>(GetOwner());
+
+	// A single instanced component draws the whole arc in one draw call
+	if (ArcMarkerMesh)
+	{
+		ArcMarkers = NewObject<UInstancedStaticMeshComponent>(GetOwner(), TEXT("TrajectoryArcMarkers"));
+		ArcMarkers->SetStaticMesh(ArcMarkerMesh);
+		ArcMarkers->SetMobility(EComponentMobility::Movable);
+		ArcMarkers->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		ArcMarkers->SetCastShadow(false);
+		ArcMarkers->SetVisibility(false);
+		ArcMarkers->RegisterComponent();
+	}
+
+	if (LandingDecalMaterial)
+	{
+		LandingDecal = NewObject<UDecalComponent>(GetOwner(), TEXT("TrajectoryLandingDecal"));
+		LandingDecal->SetDecalMaterial(LandingDecalMaterial);
+		LandingDecal->DecalSize = LandingDecalSize;
+		LandingDecal->SetVisibility(false);
+		LandingDecal->RegisterComponent();
+	}
+}
+
+void UTrajectoryPredictionComponent::TickComponent(float DeltaTime, ELevelTick TickType,
+                                                   FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	SCOPE_CYCLE_COUNTER(STAT_TrajectoryPrediction);
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	const ETrajectoryModes NewMode = ResolveMode();
+	if (NewMode == ETrajectoryModes::TM_NONE)
+	{
+		if (Mode != ETrajectoryModes::TM_NONE)
+		{
+			Mode = ETrajectoryModes::TM_NONE;
+			ShowDisplay(false);
+		}
+		return;
+	}
+
+	FVector Origin;
+	FVector Velocity;
+	GatherInputs(NewMode, Origin, Velocity);
+
+	if (NewMode != Mode)
+	{
+		// The path of the other mode is meaningless now, hide it until the new one is swept
+		ShowDisplay(false);
+		Mode = NewMode;
+		Integrate(Origin, Velocity);
+	}
+	else if (bPredictionComplete && NeedsRebuild(Origin, Velocity))
+	{
+		Integrate(Origin, Velocity);
+	}
+
+	if (!bPredictionComplete)
+	{
+		ContinueSweeps(StartCycles);
+	}
+}
+
+ETrajectoryModes UTrajectoryPredictionComponent::ResolveMode() const
+{
+	if (!OwnerCharacter) return ETrajectoryModes::TM_NONE;
+
+	if (OwnerCharacter->CurrentMT == EMovementTypes::MM_GLIDING)
+	{
+		return ETrajectoryModes::TM_GLIDE;
+	}
+
+	if (OwnerCharacter->bReadyToThrow)
+	{
+		return ETrajectoryModes::TM_THROW;
+	}
+
+	return ETrajectoryModes::TM_NONE;
+}
+
+void UTrajectoryPredictionComponent::GatherInputs(ETrajectoryModes InMode, FVector& OutOrigin,
+                                                  FVector& OutVelocity) const
+{
+	if (InMode == ETrajectoryModes::TM_THROW)
+	{
+		OutOrigin = OwnerCharacter->GetActorLocation() + ThrowOriginOffset;
+
+		// Throw along the camera direction, lifted a bit so a level camera still gives an arc
+		const FRotator ControlRotation = OwnerCharacter->GetControlRotation();
+		const float Pitch = FMath::Clamp(FRotator::NormalizeAxis(ControlRotation.Pitch) + ThrowPitchBias, -89.0f,
+		                                 89.0f);
+		OutVelocity = FRotator(Pitch, ControlRotation.Yaw, 0.0f).Vector() * ThrowSpeed;
+		return;
+	}
+
+	// Gliding keeps its horizontal speed and sinks at a constant rate, see AMyCharacterBase::AddGravityForFlying
+	OutOrigin = OwnerCharacter->GetActorLocation();
+	const FVector CurrentVelocity = OwnerCharacter->GetVelocity();
+	OutVelocity = FVector(CurrentVelocity.X, CurrentVelocity.Y, -OwnerCharacter->GlideSinkSpeed);
+}
+
+bool UTrajectoryPredictionComponent::NeedsRebuild(const FVector& Origin, const FVector& Velocity) const
+{
+	const float Tolerance = FMath::Max(VelocityTolerance, RelativeVelocityTolerance * PredictionVelocity.Size());
+	if (!FVector::PointsAreNear(Velocity, PredictionVelocity, Tolerance)) return true;
+
+	const UWindFieldSubsystem* WindField = GetWorld()->GetSubsystem<UWindFieldSubsystem>();
+	if (WindField && WindField->GetVersion() != PredictionWindVersion) return true;
+
+	if (Mode == ETrajectoryModes::TM_THROW)
+	{
+		return !FVector::PointsAreNear(Origin, PredictionOrigin, PositionTolerance);
+	}
+
+	// A glider follows its own prediction, so compare against where the path says it should be by now
+	const float SampleTime = (GetWorld()->GetTimeSeconds() - PredictionWorldTime) / StepTime;
+	const int32 Index = FMath::FloorToInt32(SampleTime);
+	if (Index + 1 >= NumSamples) return true;
+
+	const FVector Expected = FMath::Lerp(GetSample(Index), GetSample(Index + 1), SampleTime - Index);
+	return !FVector::PointsAreNear(Origin, Expected, PositionTolerance);
+}
+
+void UTrajectoryPredictionComponent::Integrate(const FVector& Origin, const FVector& Velocity)
+{
+	const UWorld* World = GetWorld();
+	const UWindFieldSubsystem* WindField = World->GetSubsystem<UWindFieldSubsystem>();
+
+	PredictionOrigin = Origin;
+	PredictionVelocity = Velocity;
+	PredictionWorldTime = World->GetTimeSeconds();
+	PredictionWindVersion = WindField ? WindField->GetVersion() : 0;
+
+	bPredictionComplete = false;
+	bHasImpact = false;
+	SweepCursor = 0;
+
+	// Sample 0 is the origin, every batch appends four samples
+	const int32 NumBatches = FMath::DivideAndRoundUp(FMath::Max(MaxSamples, 1), BatchSize);
+	NumSamples = 1 + NumBatches * BatchSize;
+	SampleX.SetNumUninitialized(NumSamples);
+	SampleY.SetNumUninitialized(NumSamples);
+	SampleZ.SetNumUninitialized(NumSamples);
+	SampleX[0] = SampleY[0] = SampleZ[0] = 0.0f;
+
+	const bool bGlide = Mode == ETrajectoryModes::TM_GLIDE;
+	const float BatchTime = StepTime * BatchSize;
+	const FVector3f Acceleration = bGlide ? FVector3f::ZeroVector : FVector3f(0.0f, 0.0f, World->GetGravityZ());
+
+	const VectorRegister4Float T = VectorMultiply(MakeVectorRegisterFloat(1.0f, 2.0f, 3.0f, 4.0f),
+	                                              VectorSetFloat1(StepTime));
+	const VectorRegister4Float HalfT2 = VectorMultiply(VectorMultiply(T, T), VectorSetFloat1(0.5f));
+
+	// Positions are relative to the origin so float precision holds in large worlds
+	FVector3f P = FVector3f::ZeroVector;
+	FVector3f V(Velocity);
+	for (int32 Batch = 0; Batch < NumBatches; ++Batch)
+	{
+		if (bGlide && WindField)
+		{
+			// Lift is sampled once per batch, a tunnel is much larger than the distance covered by four steps
+			V = FVector3f(Velocity + WindField->SampleLiftVelocity(Origin + FVector(P)));
+		}
+
+		const int32 Base = 1 + Batch * BatchSize;
+		VectorStore(IntegrateAxis(P.X, V.X, Acceleration.X, T, HalfT2), &SampleX[Base]);
+		VectorStore(IntegrateAxis(P.Y, V.Y, Acceleration.Y, T, HalfT2), &SampleY[Base]);
+		VectorStore(IntegrateAxis(P.Z, V.Z, Acceleration.Z, T, HalfT2), &SampleZ[Base]);
+
+		P = FVector3f(SampleX[Base + BatchSize - 1], SampleY[Base + BatchSize - 1], SampleZ[Base + BatchSize - 1]);
+		V += Acceleration * BatchTime;
+	}
+}
+
+void UTrajectoryPredictionComponent::ContinueSweeps(uint64 StartCycles)
+{
+	const UWorld* World = GetWorld();
+	const int32 NumBatches = (NumSamples - 1) / BatchSize;
+
+	const float Radius = Mode == ETrajectoryModes::TM_GLIDE
+		                     ? OwnerCharacter->GetCapsuleComponent()->GetScaledCapsuleRadius()
+		                     : ProjectileRadius;
+	const FCollisionShape Shape = FCollisionShape::MakeSphere(Radius);
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(TrajectoryPrediction), false, GetOwner());
+
+	// Water volumes do not block the sweep, a glider lands on the surface instead
+	UWaterQuerySubsystem* WaterQuery = Mode == ETrajectoryModes::TM_GLIDE
+		                                   ? World->GetSubsystem<UWaterQuerySubsystem>()
+		                                   : nullptr;
+
+	int32 NumSweeps = 0;
+	while (SweepCursor < NumBatches)
+	{
+		// One coarse sweep covers a whole batch instead of one trace per sample
+		const int32 First = SweepCursor * BatchSize;
+		const int32 Last = First + BatchSize;
+		++SweepCursor;
+		++NumSweeps;
+
+		const FVector SegmentStart = GetSample(First);
+		FVector SegmentEnd = GetSample(Last);
+
+		// A cached cell lookup per batch, cheaper than the sweep it may shorten
+		bool bReachesWater = false;
+		if (WaterQuery)
+		{
+			const FWaterSample Water = WaterQuery->Query(SegmentEnd);
+			if (Water.IsSubmerged(SegmentEnd.Z) && SegmentStart.Z > Water.SurfaceHeight)
+			{
+				const float Alpha = (SegmentStart.Z - Water.SurfaceHeight) / (SegmentStart.Z - SegmentEnd.Z);
+				SegmentEnd = FMath::Lerp(SegmentStart, SegmentEnd, Alpha);
+				bReachesWater = true;
+			}
+		}
+
+		FHitResult Hit;
+		const bool bBlocked = World->SweepSingleByChannel(Hit, SegmentStart, SegmentEnd, FQuat::Identity,
+		                                                  ECC_Visibility, Shape, Params);
+		if (bBlocked || bReachesWater)
+		{
+			bHasImpact = true;
+			ImpactLocation = bBlocked ? FVector(Hit.ImpactPoint) : SegmentEnd;
+			ImpactNormal = bBlocked ? FVector(Hit.ImpactNormal) : FVector::UpVector;
+
+			// Trim the path so it ends where the sweep stopped
+			const FVector3f Stop((bBlocked ? FVector(Hit.Location) : SegmentEnd) - PredictionOrigin);
+			SampleX[First + 1] = Stop.X;
+			SampleY[First + 1] = Stop.Y;
+			SampleZ[First + 1] = Stop.Z;
+			NumSamples = First + 2;
+			break;
+		}
+
+		const double ElapsedMicroseconds = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles)
+			* 1000.0;
+		if (ElapsedMicroseconds >= SweepBudgetMicroseconds) break;
+	}
+
+	INC_DWORD_STAT_BY(STAT_TrajectorySweeps, NumSweeps);
+
+	if (bHasImpact || SweepCursor >= NumBatches)
+	{
+		bPredictionComplete = true;
+		UpdateDisplay();
+	}
+}
+
+FVector UTrajectoryPredictionComponent::GetSample(int32 Index) const
+{
+	return PredictionOrigin + FVector(SampleX[Index], SampleY[Index], SampleZ[Index]);
+}
+
+void UTrajectoryPredictionComponent::UpdateDisplay()
+{
+	if (ArcMarkers)
+	{
+		ArcTransforms.Reset();
+		const int32 Stride = FMath::Max(ArcMarkerStride, 1);
+		for (int32 Index = Stride; Index < NumSamples; Index += Stride)
+		{
+			ArcTransforms.Emplace(GetSample(Index));
+		}
+
+		ArcMarkers->ClearInstances();
+		ArcMarkers->AddInstances(ArcTransforms, false, true);
+		// The glide path is only used for its landing point
+		ArcMarkers->SetVisibility(Mode == ETrajectoryModes::TM_THROW);
+	}
+
+	if (LandingDecal)
+	{
+		// Decals project along their X axis, point it into the surface
+		LandingDecal->SetWorldLocationAndRotation(ImpactLocation, (-ImpactNormal).Rotation());
+		LandingDecal->SetVisibility(bHasImpact);
+	}
+}
+
+void UTrajectoryPredictionComponent::ShowDisplay(bool bShow)
+{
+	if (ArcMarkers)
+	{
+		ArcMarkers->SetVisibility(bShow);
+	}
+
+	if (LandingDecal)
+	{
+		LandingDecal->SetVisibility(bShow);
+	}
+}
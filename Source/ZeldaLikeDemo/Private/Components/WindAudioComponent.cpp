@@ -0,0 +1,110 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Components/WindAudioComponent.h"
+
+#include "ZeldaLikeDemo.h"
+#include "Characters/MyCharacterBase.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Systems/WindFieldSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Wind Synth"), STAT_WindSynth, STATGROUP_ZeldaLikeDemo);
+
+UWindAudioComponent::UWindAudioComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+
+	// Started once the owner turns out to be the local player
+	bAutoActivate = false;
+}
+
+void UWindAudioComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	OwnerCharacter = Cast<AMyCharacterBase>(GetOwner());
+}
+
+bool UWindAudioComponent::Init(int32& SampleRate)
+{
+	NumChannels = 1;
+	Synth.Init(static_cast<float>(SampleRate));
+	return true;
+}
+
+int32 UWindAudioComponent::OnGenerateAudio(float* OutAudio, int32 NumSamples)
+{
+	SCOPE_CYCLE_COUNTER(STAT_WindSynth);
+
+	Synth.SetParams(GetParams());
+	Synth.Generate(OutAudio, NumSamples);
+	return NumSamples;
+}
+
+void UWindAudioComponent::TickComponent(float DeltaTime, ELevelTick TickType,
+                                        FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	if (!OwnerCharacter) return;
+
+	// Possession can change after BeginPlay, remote and AI characters stay silent
+	const bool bLocalPlayer = OwnerCharacter->IsLocallyControlled() && OwnerCharacter->IsPlayerControlled();
+	if (bLocalPlayer != bSynthStarted)
+	{
+		bSynthStarted = bLocalPlayer;
+		bLocalPlayer ? Start() : Stop();
+	}
+	if (!bLocalPlayer) return;
+
+	const FWindSynth::FParams Params = ComputeParams();
+	Airspeed.store(Params.Airspeed, std::memory_order_relaxed);
+	Lift.store(Params.Lift, std::memory_order_relaxed);
+	Breath.store(Params.Breath, std::memory_order_relaxed);
+}
+
+FWindSynth::FParams UWindAudioComponent::GetParams() const
+{
+	FWindSynth::FParams Params;
+	Params.Airspeed = Airspeed.load(std::memory_order_relaxed);
+	Params.Lift = Lift.load(std::memory_order_relaxed);
+	Params.Breath = Breath.load(std::memory_order_relaxed);
+	return Params;
+}
+
+FWindSynth::FParams UWindAudioComponent::ComputeParams() const
+{
+	FWindSynth::FParams Params;
+	const EMovementTypes MovementType = OwnerCharacter->CurrentMT;
+
+	// Air rushes past only while airborne
+	if (MovementType == EMovementTypes::MM_GLIDING || OwnerCharacter->GetCharacterMovement()->IsFalling())
+	{
+		Params.Airspeed = FMath::Min(OwnerCharacter->GetVelocity().Size() / FullWindAirspeed, 1.0f);
+	}
+
+	if (const UWindFieldSubsystem* WindField = GetWorld()->GetSubsystem<UWindFieldSubsystem>())
+	{
+		const FVector LiftVelocity = WindField->SampleLiftVelocity(OwnerCharacter->GetActorLocation());
+		Params.Lift = FMath::Min(LiftVelocity.Size() / FullLiftSpeed, 1.0f);
+	}
+
+	const float Fatigue = OwnerCharacter->MaxStamina > 0.0f
+		                      ? 1.0f - FMath::Clamp(OwnerCharacter->CurrentStamina / OwnerCharacter->MaxStamina,
+		                                            0.0f, 1.0f)
+		                      : 0.0f;
+	if (MovementType == EMovementTypes::MM_EXHAUSTED)
+	{
+		Params.Breath = 1.0f;
+	}
+	else if (MovementType == EMovementTypes::MM_SPRINTING || MovementType == EMovementTypes::MM_CLIMBING ||
+		OwnerCharacter->bSwimSprinting)
+	{
+		Params.Breath = FMath::Lerp(ExertionBreath, 1.0f, Fatigue);
+	}
+	else
+	{
+		Params.Breath = Fatigue * RecoveryBreath;
+	}
+
+	return Params;
+}
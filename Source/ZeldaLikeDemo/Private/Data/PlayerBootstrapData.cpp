@@ -0,0 +1,12 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Data/PlayerBootstrapData.h"
+
+const FPrimaryAssetType UPlayerBootstrapData::PrimaryAssetType(TEXT("PlayerBootstrapData"));
+const FName UPlayerBootstrapData::BootstrapBundle(TEXT("PlayerBootstrap"));
+
+FPrimaryAssetId UPlayerBootstrapData::GetPrimaryAssetId() const
+{
+	return FPrimaryAssetId(PrimaryAssetType, GetFName());
+}
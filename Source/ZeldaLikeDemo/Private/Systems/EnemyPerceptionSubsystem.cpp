@@ -0,0 +1,149 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Systems/EnemyPerceptionSubsystem.h"
+
+#include "ZeldaLikeDemo.h"
+#include "Characters/EnemyCharacterBase.h"
+#include "Characters/MyCharacterBase.h"
+#include "Kismet/GameplayStatics.h"
+
+DECLARE_CYCLE_STAT(TEXT("Enemy Perception"), STAT_EnemyPerception, STATGROUP_ZeldaLikeDemo);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemy Perception Updates"), STAT_EnemyPerceptionUpdates, STATGROUP_ZeldaLikeDemo);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemy Sight Traces"), STAT_EnemySightTraces, STATGROUP_ZeldaLikeDemo);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemy Perception Backlog"), STAT_EnemyPerceptionBacklog, STATGROUP_ZeldaLikeDemo);
+
+void UEnemyPerceptionSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemyPerception);
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	UWorld* World = GetWorld();
+	const AMyCharacterBase* Player = Cast<AMyCharacterBase>(UGameplayStatics::GetPlayerPawn(World, 0));
+	if (!Player || Agents.IsEmpty()) return;
+
+	const double Now = World->GetTimeSeconds();
+	const FVector PlayerLocation = Player->GetActorLocation();
+	const float Loudness = Player->GetNoiseLoudness();
+
+	int32 NumUpdates = ApplyCompletedTraces(PlayerLocation, Now);
+
+	// Near enemies are due more often, so they also sort first when many are due at once
+	DueAgents.Reset();
+	for (int32 Index = 0; Index < Agents.Num(); ++Index)
+	{
+		const FAgent& Agent = Agents[Index];
+		const AEnemyCharacterBase* Enemy = Agent.Enemy.Get();
+		if (!Enemy || Agent.PendingTrace.IsValid()) continue;
+
+		const float Distance = FVector::Dist(Enemy->GetActorLocation(), PlayerLocation);
+		const float Overdue = (Now - Agent.LastUpdateTime) / GetInterval(Distance);
+		if (Overdue >= 1.0f)
+		{
+			DueAgents.Emplace(Overdue, Index);
+		}
+	}
+	DueAgents.Sort([](const TPair<float, int32>& A, const TPair<float, int32>& B) { return A.Key > B.Key; });
+
+	int32 NumTraces = 0;
+	int32 NumProcessed = 0;
+	for (const TPair<float, int32>& Due : DueAgents)
+	{
+		const double ElapsedMicroseconds = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles)
+			* 1000.0;
+		if (ElapsedMicroseconds >= BudgetMicroseconds) break;
+
+		FAgent& Agent = Agents[Due.Value];
+		AEnemyCharacterBase* Enemy = Agent.Enemy.Get();
+		const bool bHeard = FVector::DistSquared(Enemy->GetActorLocation(), PlayerLocation) <=
+			FMath::Square(Enemy->HearingRadius * Loudness);
+
+		if (Enemy->IsInSightCone(PlayerLocation))
+		{
+			// Left due for next frame once this frame's batch is full
+			if (NumTraces >= MaxTracesPerFrame) continue;
+
+			FCollisionQueryParams Params(SCENE_QUERY_STAT(EnemySight), false, Enemy);
+			Params.AddIgnoredActor(Player);
+			Agent.PendingTrace = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Enemy->GetPawnViewLocation(),
+			                                                    PlayerLocation, ECC_Visibility, Params);
+			Agent.TraceFrame = GFrameCounter;
+			Agent.bHeard = bHeard;
+			++NumTraces;
+		}
+		else
+		{
+			Enemy->ApplyPerception(false, bHeard, PlayerLocation, Now - Agent.LastUpdateTime);
+			Agent.LastUpdateTime = Now;
+			++NumUpdates;
+		}
+		++NumProcessed;
+	}
+
+	INC_DWORD_STAT_BY(STAT_EnemyPerceptionUpdates, NumUpdates);
+	INC_DWORD_STAT_BY(STAT_EnemySightTraces, NumTraces);
+	INC_DWORD_STAT_BY(STAT_EnemyPerceptionBacklog, DueAgents.Num() - NumProcessed);
+}
+
+TStatId UEnemyPerceptionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyPerceptionSubsystem, STATGROUP_Tickables);
+}
+
+void UEnemyPerceptionSubsystem::RegisterEnemy(AEnemyCharacterBase* Enemy)
+{
+	if (!Enemy) return;
+
+	// Stagger the first updates so enemies spawned together are not all due in the same frame
+	FAgent& Agent = Agents.AddDefaulted_GetRef();
+	Agent.Enemy = Enemy;
+	Agent.LastUpdateTime = GetWorld()->GetTimeSeconds() - FMath::FRand() * NearInterval;
+}
+
+void UEnemyPerceptionSubsystem::UnregisterEnemy(AEnemyCharacterBase* Enemy)
+{
+	Agents.RemoveAllSwap([Enemy](const FAgent& Agent) { return Agent.Enemy == Enemy || !Agent.Enemy.IsValid(); });
+}
+
+bool UEnemyPerceptionSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+int32 UEnemyPerceptionSubsystem::ApplyCompletedTraces(const FVector& PlayerLocation, double Now)
+{
+	UWorld* World = GetWorld();
+
+	int32 NumApplied = 0;
+	FTraceDatum Datum;
+	for (FAgent& Agent : Agents)
+	{
+		if (!Agent.PendingTrace.IsValid()) continue;
+
+		AEnemyCharacterBase* Enemy = Agent.Enemy.Get();
+		if (Enemy && World->QueryTraceData(Agent.PendingTrace, Datum))
+		{
+			const bool bSeen = !Datum.OutHits.ContainsByPredicate([](const FHitResult& Hit)
+			{
+				return Hit.bBlockingHit;
+			});
+			Enemy->ApplyPerception(bSeen, Agent.bHeard, PlayerLocation, Now - Agent.LastUpdateTime);
+			Agent.LastUpdateTime = Now;
+			Agent.PendingTrace = FTraceHandle();
+			++NumApplied;
+		}
+		else if (GFrameCounter - Agent.TraceFrame > 2)
+		{
+			// Async results are only kept for one frame, give up on a missed one and reschedule
+			Agent.PendingTrace = FTraceHandle();
+		}
+	}
+	return NumApplied;
+}
+
+float UEnemyPerceptionSubsystem::GetInterval(float Distance) const
+{
+	const float Alpha = FMath::Clamp((Distance - NearDistance) / FMath::Max(FarDistance - NearDistance, 1.0f), 0.0f,
+	                                 1.0f);
+	return FMath::Lerp(NearInterval, FarInterval, Alpha);
+}
@@ -0,0 +1,357 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Systems/ExplosionFieldSubsystem.h"
+
+#include "ZeldaLikeDemo.h"
+#include "Chaos/ISpatialAcceleration.h"
+#include "Chaos/SimCallbackInput.h"
+#include "Chaos/SimCallbackObject.h"
+#include "Curves/CurveFloat.h"
+#include "Engine/OverlapResult.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/DamageType.h"
+#include "Kismet/GameplayStatics.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+#include "PBDRigidsSolver.h"
+
+DECLARE_CYCLE_STAT(TEXT("Explosion Field (physics thread)"), STAT_ExplosionField, STATGROUP_ZeldaLikeDemo);
+DECLARE_CYCLE_STAT(TEXT("Explosion Damage"), STAT_ExplosionDamage, STATGROUP_ZeldaLikeDemo);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Explosion Bodies Pushed"), STAT_ExplosionBodiesPushed, STATGROUP_ZeldaLikeDemo);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Explosion Actors Damaged"), STAT_ExplosionActorsDamaged, STATGROUP_ZeldaLikeDemo);
+
+namespace
+{
+	/** Resolution of the impulse curve handed to the physics thread */
+	constexpr int32 NumFalloffSamples = 16;
+
+	/** A blast as seen by the physics thread, curves are baked so no UObject is touched there */
+	struct FExplosionBlast
+	{
+		/** Increases with every blast, matches the damage kept on the game thread */
+		uint32 Id = 0;
+		FVector Origin = FVector::ZeroVector;
+		float Radius = 0.0f;
+		float Impulse = 0.0f;
+		/** Whether the pushed bodies are reported back for damage */
+		bool bDamage = false;
+		float FalloffSamples[NumFalloffSamples] = {};
+
+		/** Impulse scale at a normalized distance from the center */
+		float SampleFalloff(float Alpha) const
+		{
+			const float Position = FMath::Clamp(Alpha, 0.0f, 1.0f) * (NumFalloffSamples - 1);
+			const int32 Index = FMath::Min(FMath::FloorToInt32(Position), NumFalloffSamples - 2);
+			return FMath::Lerp(FalloffSamples[Index], FalloffSamples[Index + 1], Position - Index);
+		}
+	};
+
+	using FAccelerationVisitor = Chaos::ISpatialVisitor<Chaos::FAccelerationStructureHandle, Chaos::FReal>;
+	using FAccelerationVisitorData = Chaos::TSpatialVisitorData<Chaos::FAccelerationStructureHandle>;
+
+	/** Collects the simulated bodies whose bounds overlap a blast */
+	class FBlastBodyVisitor final : public FAccelerationVisitor
+	{
+	public:
+		explicit FBlastBodyVisitor(TSet<Chaos::FPBDRigidParticleHandle*>& InBodies)
+			: Bodies(InBodies)
+		{
+		}
+
+		virtual bool Overlap(const FAccelerationVisitorData& Instance) override
+		{
+			Chaos::FGeometryParticleHandle* Particle = Instance.Payload.GetGeometryParticleHandle_PhysicsThread();
+			Chaos::FPBDRigidParticleHandle* Rigid = Particle ? Particle->CastToRigidParticle() : nullptr;
+			if (Rigid && !Rigid->Disabled() && (Rigid->ObjectState() == Chaos::EObjectStateType::Dynamic ||
+				Rigid->ObjectState() == Chaos::EObjectStateType::Sleeping))
+			{
+				Bodies.Add(Rigid);
+			}
+			return true;
+		}
+
+		virtual bool Raycast(const FAccelerationVisitorData& Instance, Chaos::FQueryFastData& CurData) override
+		{
+			return true;
+		}
+
+		virtual bool Sweep(const FAccelerationVisitorData& Instance, Chaos::FQueryFastData& CurData) override
+		{
+			return true;
+		}
+
+	private:
+		TSet<Chaos::FPBDRigidParticleHandle*>& Bodies;
+	};
+
+	/** Damage scale per actor, the nearest of an actor's components counts */
+	using FDamagedActorMap = TMap<AActor*, float, TInlineSetAllocator<32>>;
+
+	void AddDamagedActor(FDamagedActorMap& DamagedActors, AActor* Actor, float DamageScale)
+	{
+		float& ActorDamageScale = DamagedActors.FindOrAdd(Actor, 0.0f);
+		ActorDamageScale = FMath::Max(ActorDamageScale, DamageScale);
+	}
+
+	void ApplyDamageToActors(const FDamagedActorMap& DamagedActors, float Damage, AActor* DamageCauser,
+	                         AController* InstigatorController)
+	{
+		INC_DWORD_STAT_BY(STAT_ExplosionActorsDamaged, DamagedActors.Num());
+		for (const TPair<AActor*, float>& Damaged : DamagedActors)
+		{
+			// An earlier hit may have destroyed it
+			if (IsValid(Damaged.Key) && Damaged.Value > 0.0f)
+			{
+				UGameplayStatics::ApplyDamage(Damaged.Key, Damage * Damaged.Value, InstigatorController, DamageCauser,
+				                              UDamageType::StaticClass());
+			}
+		}
+	}
+}
+
+struct FExplosionFieldInput : public Chaos::FSimCallbackInput
+{
+	TArray<FExplosionBlast> Blasts;
+
+	void Reset()
+	{
+		Blasts.Reset();
+	}
+};
+
+/** A pushed body within a blast's damage radius */
+struct FExplosionBodyHit
+{
+	/** Looked up on the game thread, where the owning component can be resolved safely */
+	IPhysicsProxyBase* Proxy = nullptr;
+	uint32 BlastId = 0;
+	/** Linear damage falloff from 1 at the center to 0 at the edge */
+	float DamageScale = 0.0f;
+};
+
+struct FExplosionFieldOutput : public Chaos::FSimCallbackOutput
+{
+	/** Blasts applied in this step, with or without hits, so the game thread can drop their damage */
+	TArray<uint32> BlastIds;
+	TArray<FExplosionBodyHit> Hits;
+
+	void Reset()
+	{
+		BlastIds.Reset();
+		Hits.Reset();
+	}
+};
+
+/**
+ * Runs before each physics step and pushes the bodies in the bounds of all queued blasts in a single pass.
+ */
+class FExplosionFieldCallback : public Chaos::TSimCallbackObject<FExplosionFieldInput, FExplosionFieldOutput>
+{
+	virtual void OnPreSimulate_Internal() override
+	{
+		const FExplosionFieldInput* Input = GetConsumerInput_Internal();
+		if (!Input || Input->Blasts.IsEmpty()) return;
+
+		// Substeps of one game thread frame see the same input, each blast is applied once
+		Blasts.Reset();
+		for (const FExplosionBlast& Blast : Input->Blasts)
+		{
+			if (Blast.Id > LastBlastId)
+			{
+				Blasts.Add(&Blast);
+				LastBlastId = Blast.Id;
+			}
+		}
+		if (Blasts.IsEmpty()) return;
+
+		SCOPE_CYCLE_COUNTER(STAT_ExplosionField);
+
+		Chaos::FPBDRigidsSolver* Solver = static_cast<Chaos::FPBDRigidsSolver*>(GetSolver());
+		Chaos::FPBDRigidsEvolution& Evolution = *Solver->GetEvolution();
+		const Chaos::FPBDRigidsEvolution::FAccelerationStructure* Acceleration = Evolution.GetSpatialAcceleration();
+		FExplosionFieldOutput& Output = GetProducerOutputData_Internal();
+		for (const FExplosionBlast* Blast : Blasts)
+		{
+			Output.BlastIds.Add(Blast->Id);
+		}
+		if (!Acceleration) return;
+
+		// Only the bodies in the blast bounds are visited, however many the level holds
+		Bodies.Reset();
+		FBlastBodyVisitor Visitor(Bodies);
+		for (const FExplosionBlast* Blast : Blasts)
+		{
+			const Chaos::FVec3 Extent(Blast->Radius);
+			Acceleration->Overlap(Chaos::FAABB3(Blast->Origin - Extent, Blast->Origin + Extent), Visitor);
+		}
+
+		int32 NumPushed = 0;
+		for (Chaos::FPBDRigidParticleHandle* Body : Bodies)
+		{
+			const Chaos::FVec3 Position = Body->GetX();
+			Chaos::FVec3 TotalImpulse(0.0);
+
+			for (const FExplosionBlast* Blast : Blasts)
+			{
+				const Chaos::FVec3 Offset = Position - Blast->Origin;
+				const Chaos::FReal DistanceSquared = Offset.SizeSquared();
+				if (DistanceSquared >= FMath::Square(Blast->Radius)) continue;
+
+				const Chaos::FReal Distance = FMath::Sqrt(DistanceSquared);
+				const float Alpha = static_cast<float>(Distance / Blast->Radius);
+				const Chaos::FVec3 Direction = Distance > UE_KINDA_SMALL_NUMBER
+					                               ? Offset / Distance
+					                               : Chaos::FVec3(0.0, 0.0, 1.0);
+				TotalImpulse += Direction * (Blast->Impulse * Blast->SampleFalloff(Alpha));
+
+				if (Blast->bDamage)
+				{
+					Output.Hits.Add({Body->PhysicsProxy(), Blast->Id, 1.0f - Alpha});
+				}
+			}
+
+			if (TotalImpulse.IsNearlyZero()) continue;
+
+			// Waking moves the particle between views, the set is not touched by it
+			if (Body->ObjectState() == Chaos::EObjectStateType::Sleeping)
+			{
+				Evolution.SetParticleObjectState(Body, Chaos::EObjectStateType::Dynamic);
+			}
+			Body->SetV(Body->GetV() + TotalImpulse * Body->InvM());
+			++NumPushed;
+		}
+
+		INC_DWORD_STAT_BY(STAT_ExplosionBodiesPushed, NumPushed);
+	}
+
+	/** Scratch set kept between steps so a blast does not allocate on the physics thread */
+	TSet<Chaos::FPBDRigidParticleHandle*> Bodies;
+
+	/** Blasts of the current step not applied in an earlier substep */
+	TArray<const FExplosionBlast*> Blasts;
+
+	uint32 LastBlastId = 0;
+};
+
+void UExplosionFieldSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (FPhysScene* Scene = InWorld.GetPhysicsScene())
+	{
+		Callback = Scene->GetSolver()->CreateAndRegisterSimCallbackObject_External<FExplosionFieldCallback>();
+		PostTickHandle = Scene->OnPhysScenePostTick.AddUObject(this, &UExplosionFieldSubsystem::OnPhysScenePostTick);
+	}
+}
+
+void UExplosionFieldSubsystem::Deinitialize()
+{
+	if (Callback)
+	{
+		if (FPhysScene* Scene = GetWorld()->GetPhysicsScene())
+		{
+			Scene->OnPhysScenePostTick.Remove(PostTickHandle);
+			Scene->GetSolver()->UnregisterAndFreeSimCallbackObject_External(Callback);
+		}
+		Callback = nullptr;
+		PendingDamage.Reset();
+	}
+
+	Super::Deinitialize();
+}
+
+void UExplosionFieldSubsystem::Detonate(const FVector& Origin, const FExplosionParams& Params, AActor* DamageCauser,
+                                        AController* InstigatorController)
+{
+	if (Params.Radius <= 0.0f) return;
+
+	if (Callback && Params.Impulse != 0.0f)
+	{
+		FExplosionBlast Blast;
+		Blast.Id = ++LastBlastId;
+		Blast.bDamage = Params.Damage > 0.0f;
+		Blast.Origin = Origin;
+		Blast.Radius = Params.Radius;
+		Blast.Impulse = Params.Impulse;
+		for (int32 Index = 0; Index < NumFalloffSamples; ++Index)
+		{
+			const float Alpha = static_cast<float>(Index) / (NumFalloffSamples - 1);
+			Blast.FalloffSamples[Index] = Params.ImpulseCurve ? Params.ImpulseCurve->GetFloatValue(Alpha) : 1.0f - Alpha;
+		}
+
+		// Every blast of this frame goes into the same input and runs in the same physics step
+		Callback->GetProducerInputData_External()->Blasts.Add(Blast);
+		if (Blast.bDamage)
+		{
+			PendingDamage.Add(Blast.Id, {Params.Damage, DamageCauser, InstigatorController});
+		}
+	}
+
+	if (Params.Damage > 0.0f)
+	{
+		ApplyPawnDamage(Origin, Params, DamageCauser, InstigatorController);
+	}
+}
+
+void UExplosionFieldSubsystem::ApplyPawnDamage(const FVector& Origin, const FExplosionParams& Params,
+                                               AActor* DamageCauser, AController* InstigatorController) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_ExplosionDamage);
+
+	const FCollisionObjectQueryParams ObjectParams(ECC_Pawn);
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ExplosionDamage), false, DamageCauser);
+
+	TArray<FOverlapResult> Overlaps;
+	GetWorld()->OverlapMultiByObjectType(Overlaps, Origin, FQuat::Identity, ObjectParams,
+	                                     FCollisionShape::MakeSphere(Params.Radius), QueryParams);
+
+	// Local so a bomb set off by this damage can detonate from inside ApplyDamageToActors
+	FDamagedActorMap DamagedActors;
+	for (const FOverlapResult& Overlap : Overlaps)
+	{
+		const UPrimitiveComponent* Component = Overlap.GetComponent();
+		AActor* Actor = Overlap.GetActor();
+		if (!Component || !Actor) continue;
+
+		const double Distance = FMath::Sqrt(Component->Bounds.GetBox().ComputeSquaredDistanceToPoint(Origin));
+		const float Alpha = FMath::Clamp(static_cast<float>(Distance / Params.Radius), 0.0f, 1.0f);
+		AddDamagedActor(DamagedActors, Actor, 1.0f - Alpha);
+	}
+
+	ApplyDamageToActors(DamagedActors, Params.Damage, DamageCauser, InstigatorController);
+}
+
+void UExplosionFieldSubsystem::OnPhysScenePostTick(FChaosScene* Scene)
+{
+	if (!Callback) return;
+
+	FPhysScene* PhysScene = GetWorld()->GetPhysicsScene();
+	while (Chaos::TSimCallbackOutputHandle<FExplosionFieldOutput> Output = Callback->PopOutputData_External())
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ExplosionDamage);
+
+		for (const uint32 BlastId : Output->BlastIds)
+		{
+			FExplosionDamage Damage;
+			if (!PendingDamage.RemoveAndCopyValue(BlastId, Damage)) continue;
+
+			FDamagedActorMap DamagedActors;
+			for (const FExplosionBodyHit& Hit : Output->Hits)
+			{
+				if (Hit.BlastId != BlastId) continue;
+
+				// Null once the body was destroyed after the step. Pawns were damaged by the overlap already
+				const UPrimitiveComponent* Component = PhysScene->GetOwningComponent<UPrimitiveComponent>(Hit.Proxy);
+				AActor* Actor = Component ? Component->GetOwner() : nullptr;
+				if (Actor && !Actor->IsA<APawn>())
+				{
+					AddDamagedActor(DamagedActors, Actor, Hit.DamageScale);
+				}
+			}
+
+			ApplyDamageToActors(DamagedActors, Damage.Damage, Damage.DamageCauser.Get(),
+			                    Damage.InstigatorController.Get());
+		}
+	}
+}
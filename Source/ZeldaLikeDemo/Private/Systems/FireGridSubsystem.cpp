@@ -0,0 +1,446 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Systems/FireGridSubsystem.h"
+
+#include "ZeldaLikeDemo.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+#include "PhysicalMaterials/PhysicalMaterial.h"
+
+DECLARE_CYCLE_STAT(TEXT("Fire Grid"), STAT_FireGrid, STATGROUP_ZeldaLikeDemo);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Fire Active Chunks"), STAT_FireActiveChunks, STATGROUP_ZeldaLikeDemo);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Fire Burning Cells"), STAT_FireBurningCells, STATGROUP_ZeldaLikeDemo);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Fire Chunks Updated"), STAT_FireChunksUpdated, STATGROUP_ZeldaLikeDemo);
+
+namespace
+{
+	/** Longest time step of one chunk update, a chunk that waited longer does not jump ahead (in seconds) */
+	constexpr float MaxStepTime = 0.5f;
+
+	/** Cells around a location that feed its updraft, in each direction */
+	constexpr int32 UpdraftRadiusCells = 2;
+
+	/** Chunk offsets of the neighbours west, east, south and north */
+	constexpr int32 NeighborX[4] = {-1, 1, 0, 0};
+	constexpr int32 NeighborY[4] = {0, 0, -1, 1};
+
+	/** Integer division rounding towards negative infinity */
+	int32 FloorDiv(int32 Dividend, int32 Divisor)
+	{
+		return Dividend >= 0 ? Dividend / Divisor : (Dividend - Divisor + 1) / Divisor;
+	}
+}
+
+void UFireGridSubsystem::Ignite(const FVector& Location, float Radius)
+{
+	// Missing chunks are created within the per frame budget, their cells catch fire then
+	if (IgniteCells(Location, Radius, nullptr))
+	{
+		PendingIgnitions.Emplace(Location, Radius);
+	}
+}
+
+bool UFireGridSubsystem::IgniteCells(const FVector& Location, float Radius, const FIntPoint* OnlyChunk)
+{
+	const FIntPoint MinCell = GetCell(Location - FVector(Radius));
+	const FIntPoint MaxCell = GetCell(Location + FVector(Radius));
+	const FVector2D Center(Location);
+	// Always reach the cell under the location, even for a tiny radius
+	const double RadiusSquared = FMath::Square(Radius + CellSize * 0.5f);
+
+	bool bMissingChunks = false;
+	bool bIgnited = false;
+	for (int32 CellY = MinCell.Y; CellY <= MaxCell.Y; ++CellY)
+	{
+		for (int32 CellX = MinCell.X; CellX <= MaxCell.X; ++CellX)
+		{
+			const FVector2D CellCenter((CellX + 0.5) * CellSize, (CellY + 0.5) * CellSize);
+			if (FVector2D::DistSquared(CellCenter, Center) > RadiusSquared) continue;
+
+			const FIntPoint Coord(FloorDiv(CellX, ChunkCells), FloorDiv(CellY, ChunkCells));
+			const int32* ChunkIndex = ChunkIndices.Find(Coord);
+			if (!ChunkIndex)
+			{
+				QueueChunk(Coord, Location.Z);
+				bMissingChunks = true;
+				continue;
+			}
+			if (OnlyChunk && Coord != *OnlyChunk) continue;
+
+			FChunk& Chunk = *Chunks[*ChunkIndex];
+			const int32 Cell = (CellY - Coord.Y * ChunkCells) * ChunkCells + CellX - Coord.X * ChunkCells;
+			Chunk.Heat[Cell] = 1.0f;
+			// Burns right away, so the neighbours heat up on the next update
+			Chunk.Emission[Cell] = Chunk.Fuel[Cell] > 0.0f ? 1.0f : 0.0f;
+			bIgnited |= Chunk.Emission[Cell] > 0.0f;
+			Activate(*ChunkIndex);
+		}
+	}
+	if (bIgnited)
+	{
+		++Version;
+	}
+	return bMissingChunks;
+}
+
+bool UFireGridSubsystem::IsBurning(const FVector& Location) const
+{
+	int32 Cell;
+	const FChunk* Chunk = FindCell(GetCell(Location), Cell);
+	return Chunk && Chunk->Emission[Cell] > 0.0f;
+}
+
+FVector UFireGridSubsystem::SampleUpdraft(const FVector& Location) const
+{
+	if (ActiveChunks.IsEmpty()) return FVector::ZeroVector;
+
+	const FIntPoint Center = GetCell(Location);
+	int32 CenterCell;
+	const FChunk* CenterChunk = FindCell(Center, CenterCell);
+	if (!CenterChunk || !CenterChunk->bActive) return FVector::ZeroVector;
+
+	const float Height = Location.Z - CenterChunk->GroundZ[CenterCell];
+	if (Height < 0.0f || Height > UpdraftHeight) return FVector::ZeroVector;
+
+	float NumBurning = 0.0f;
+	for (int32 OffsetY = -UpdraftRadiusCells; OffsetY <= UpdraftRadiusCells; ++OffsetY)
+	{
+		for (int32 OffsetX = -UpdraftRadiusCells; OffsetX <= UpdraftRadiusCells; ++OffsetX)
+		{
+			int32 Cell;
+			if (const FChunk* Chunk = FindCell(Center + FIntPoint(OffsetX, OffsetY), Cell))
+			{
+				NumBurning += Chunk->Emission[Cell];
+			}
+		}
+	}
+
+	constexpr float NumSampledCells = FMath::Square(2 * UpdraftRadiusCells + 1);
+	return FVector::UpVector * (UpdraftSpeed * NumBurning / NumSampledCells * (1.0f - Height / UpdraftHeight));
+}
+
+TStatId UFireGridSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UFireGridSubsystem, STATGROUP_Tickables);
+}
+
+bool UFireGridSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UFireGridSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	SCOPE_CYCLE_COUNTER(STAT_FireGrid);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	// Fire reached new ground, the ground traces make creating a chunk the expensive part
+	for (int32 NumCreated = 0; NumCreated < MaxChunkCreationsPerFrame && !PendingChunks.IsEmpty(); ++NumCreated)
+	{
+		const TPair<FIntPoint, float> Pending = PendingChunks[0];
+		PendingChunks.RemoveAt(0, 1, EAllowShrinking::No);
+		if (ChunkIndices.Contains(Pending.Key)) continue;
+
+		Activate(CreateChunk(Pending.Key, Pending.Value));
+		for (int32 Index = PendingIgnitions.Num() - 1; Index >= 0; --Index)
+		{
+			if (!IgniteCells(PendingIgnitions[Index].Key, PendingIgnitions[Index].Value, &Pending.Key))
+			{
+				PendingIgnitions.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+			}
+		}
+	}
+
+	SET_DWORD_STAT(STAT_FireActiveChunks, ActiveChunks.Num());
+	SET_DWORD_STAT(STAT_FireBurningCells, NumBurningCells);
+	if (ActiveChunks.IsEmpty()) return;
+
+	// Round robin over the chunks that are due, the rest waits for later frames
+	Batch.Reset();
+	const int32 NumActive = ActiveChunks.Num();
+	int32 NumExamined = 0;
+	for (; NumExamined < NumActive && Batch.Num() < MaxChunksPerFrame; ++NumExamined)
+	{
+		const int32 ChunkIndex = ActiveChunks[(UpdateCursor + NumExamined) % NumActive];
+		FChunk& Chunk = *Chunks[ChunkIndex];
+		if (Now - Chunk.LastUpdateTime < StepSeconds) continue;
+
+		Chunk.StepTime = FMath::Min(static_cast<float>(Now - Chunk.LastUpdateTime), MaxStepTime);
+		Chunk.LastUpdateTime = Now;
+		Batch.Add(ChunkIndex);
+	}
+	UpdateCursor = (UpdateCursor + NumExamined) % NumActive;
+	if (Batch.IsEmpty()) return;
+
+	// Heating reads the neighbours' emission, so emission is only rewritten once the whole batch was heated
+	ParallelFor(Batch.Num(), [this](int32 Index) { UpdateHeat(*Chunks[Batch[Index]]); });
+	ParallelFor(Batch.Num(), [this](int32 Index) { UpdateEmission(*Chunks[Batch[Index]]); });
+	INC_DWORD_STAT_BY(STAT_FireChunksUpdated, Batch.Num());
+
+	for (const int32 ChunkIndex : Batch)
+	{
+		FChunk& Chunk = *Chunks[ChunkIndex];
+		if (Chunk.BurningEdges)
+		{
+			WakeNeighbors(ChunkIndex);
+		}
+
+		// Burnt out and cooled down, costs nothing until fire reaches it again
+		if (Chunk.MaxHeat <= 0.0f)
+		{
+			Chunk.bActive = false;
+			ActiveChunks.RemoveSingleSwap(ChunkIndex, EAllowShrinking::No);
+		}
+	}
+
+	// Updrafts changed, predictions sampling them are rebuilt
+	const int32 LastNumActiveChunks = NumActive;
+	const int32 LastNumBurningCells = NumBurningCells;
+	NumBurningCells = 0;
+	for (const int32 ChunkIndex : ActiveChunks)
+	{
+		NumBurningCells += Chunks[ChunkIndex]->NumBurning;
+	}
+	if (NumBurningCells != LastNumBurningCells || ActiveChunks.Num() != LastNumActiveChunks)
+	{
+		++Version;
+	}
+}
+
+void UFireGridSubsystem::UpdateHeat(FChunk& Chunk) const
+{
+	// Emission with a one cell border taken from the neighbouring chunks, so the kernel never branches on edges
+	constexpr int32 HaloRow = ChunkCells + 2;
+	float Halo[HaloRow * HaloRow];
+	FMemory::Memzero(Halo);
+
+	for (int32 Y = 0; Y < ChunkCells; ++Y)
+	{
+		FMemory::Memcpy(&Halo[(Y + 1) * HaloRow + 1], &Chunk.Emission[Y * ChunkCells], ChunkCells * sizeof(float));
+	}
+
+	if (Chunk.Neighbors[0] != INDEX_NONE)
+	{
+		const FChunk& West = *Chunks[Chunk.Neighbors[0]];
+		for (int32 Y = 0; Y < ChunkCells; ++Y)
+		{
+			Halo[(Y + 1) * HaloRow] = West.Emission[Y * ChunkCells + ChunkCells - 1];
+		}
+	}
+	if (Chunk.Neighbors[1] != INDEX_NONE)
+	{
+		const FChunk& East = *Chunks[Chunk.Neighbors[1]];
+		for (int32 Y = 0; Y < ChunkCells; ++Y)
+		{
+			Halo[(Y + 1) * HaloRow + ChunkCells + 1] = East.Emission[Y * ChunkCells];
+		}
+	}
+	if (Chunk.Neighbors[2] != INDEX_NONE)
+	{
+		const FChunk& South = *Chunks[Chunk.Neighbors[2]];
+		FMemory::Memcpy(&Halo[1], &South.Emission[(ChunkCells - 1) * ChunkCells], ChunkCells * sizeof(float));
+	}
+	if (Chunk.Neighbors[3] != INDEX_NONE)
+	{
+		const FChunk& North = *Chunks[Chunk.Neighbors[3]];
+		FMemory::Memcpy(&Halo[(ChunkCells + 1) * HaloRow + 1], &North.Emission[0], ChunkCells * sizeof(float));
+	}
+
+	const VectorRegister4Float Zero = VectorZeroFloat();
+	const VectorRegister4Float One = VectorOneFloat();
+	const VectorRegister4Float Spread = VectorSetFloat1(SpreadRate * Chunk.StepTime);
+	const VectorRegister4Float Cooling = VectorSetFloat1(CoolingRate * Chunk.StepTime);
+	const VectorRegister4Float Burn = VectorSetFloat1(BurnRate * Chunk.StepTime);
+	VectorRegister4Float MaxHeat = Zero;
+
+	for (int32 Y = 0; Y < ChunkCells; ++Y)
+	{
+		for (int32 X = 0; X < ChunkCells; X += 4)
+		{
+			const int32 Cell = Y * ChunkCells + X;
+			const float* Center = &Halo[(Y + 1) * HaloRow + X + 1];
+
+			const VectorRegister4Float Self = VectorLoad(Center);
+			const VectorRegister4Float Neighbors = VectorAdd(
+				VectorAdd(VectorLoad(Center - 1), VectorLoad(Center + 1)),
+				VectorAdd(VectorLoad(Center - HaloRow), VectorLoad(Center + HaloRow)));
+			const VectorRegister4Float Fuel = VectorLoad(&Chunk.Fuel[Cell]);
+
+			// Only fuel soaks up the heat of the flames next to it, every cell cools
+			VectorRegister4Float Heat = VectorLoad(&Chunk.Heat[Cell]);
+			Heat = VectorAdd(Heat, VectorSelect(VectorCompareGT(Fuel, Zero), VectorMultiply(Neighbors, Spread), Zero));
+			Heat = VectorMax(VectorMin(VectorSubtract(Heat, Cooling), One), Zero);
+
+			// Burning cells stay at full heat until their fuel is gone
+			Heat = VectorSelect(VectorCompareGT(Self, Zero), One, Heat);
+
+			VectorStore(Heat, &Chunk.Heat[Cell]);
+			VectorStore(VectorMax(VectorSubtract(Fuel, VectorMultiply(Self, Burn)), Zero), &Chunk.Fuel[Cell]);
+			MaxHeat = VectorMax(MaxHeat, Heat);
+		}
+	}
+
+	float MaxHeats[4];
+	VectorStore(MaxHeat, MaxHeats);
+	Chunk.MaxHeat = FMath::Max(FMath::Max(MaxHeats[0], MaxHeats[1]), FMath::Max(MaxHeats[2], MaxHeats[3]));
+}
+
+void UFireGridSubsystem::UpdateEmission(FChunk& Chunk) const
+{
+	const VectorRegister4Float Zero = VectorZeroFloat();
+	const VectorRegister4Float One = VectorOneFloat();
+	const VectorRegister4Float Ignition = VectorSetFloat1(IgnitionHeat);
+
+	int32 NumBurning = 0;
+	for (int32 Cell = 0; Cell < NumChunkCells; Cell += 4)
+	{
+		const VectorRegister4Float Burning = VectorBitwiseAnd(
+			VectorCompareGE(VectorLoad(&Chunk.Heat[Cell]), Ignition),
+			VectorCompareGT(VectorLoad(&Chunk.Fuel[Cell]), Zero));
+		VectorStore(VectorSelect(Burning, One, Zero), &Chunk.Emission[Cell]);
+		NumBurning += FMath::CountBits(VectorMaskBits(Burning));
+	}
+	Chunk.NumBurning = NumBurning;
+
+	uint8 BurningEdges = 0;
+	for (int32 Index = 0; NumBurning > 0 && Index < ChunkCells; ++Index)
+	{
+		BurningEdges |= Chunk.Emission[Index * ChunkCells] > 0.0f ? Edge_West : 0;
+		BurningEdges |= Chunk.Emission[Index * ChunkCells + ChunkCells - 1] > 0.0f ? Edge_East : 0;
+		BurningEdges |= Chunk.Emission[Index] > 0.0f ? Edge_South : 0;
+		BurningEdges |= Chunk.Emission[(ChunkCells - 1) * ChunkCells + Index] > 0.0f ? Edge_North : 0;
+	}
+	Chunk.BurningEdges = BurningEdges;
+}
+
+int32 UFireGridSubsystem::CreateChunk(const FIntPoint& Coord, float ReferenceZ)
+{
+	const int32 ChunkIndex = Chunks.Add(MakeUnique<FChunk>());
+	FChunk& Chunk = *Chunks[ChunkIndex];
+	Chunk.Coord = Coord;
+	ChunkIndices.Add(Coord, ChunkIndex);
+
+	for (int32 Side = 0; Side < 4; ++Side)
+	{
+		if (const int32* Neighbor = ChunkIndices.Find(Coord + FIntPoint(NeighborX[Side], NeighborY[Side])))
+		{
+			// West of this chunk is east of the neighbour, and so on
+			Chunk.Neighbors[Side] = *Neighbor;
+			Chunks[*Neighbor]->Neighbors[Side ^ 1] = ChunkIndex;
+		}
+	}
+
+	const UWorld* World = GetWorld();
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(FireGridGround), false);
+	Params.bReturnPhysicalMaterial = true;
+	// Pawns and physics bodies standing around when fire arrives are not the ground
+	const FCollisionObjectQueryParams ObjectParams(ECC_WorldStatic);
+
+	double SumZ = 0.0;
+	int32 NumGround = 0;
+	for (int32 Y = 0; Y < ChunkCells; ++Y)
+	{
+		for (int32 X = 0; X < ChunkCells; ++X)
+		{
+			const int32 Cell = Y * ChunkCells + X;
+			const FVector2D CellCenter((Coord.X * ChunkCells + X + 0.5) * CellSize,
+			                           (Coord.Y * ChunkCells + Y + 0.5) * CellSize);
+			Chunk.Heat[Cell] = 0.0f;
+			Chunk.Emission[Cell] = 0.0f;
+			Chunk.Fuel[Cell] = 0.0f;
+			Chunk.GroundZ[Cell] = ReferenceZ;
+
+			FHitResult Hit;
+			if (World->LineTraceSingleByObjectType(Hit, FVector(CellCenter, ReferenceZ + GroundSearchDistance),
+			                                       FVector(CellCenter, ReferenceZ - GroundSearchDistance),
+			                                       ObjectParams, Params))
+			{
+				Chunk.GroundZ[Cell] = Hit.ImpactPoint.Z;
+				Chunk.Fuel[Cell] = IsFlammable(Hit) ? 1.0f : 0.0f;
+				SumZ += Hit.ImpactPoint.Z;
+				++NumGround;
+			}
+		}
+	}
+	Chunk.ReferenceZ = NumGround > 0 ? SumZ / NumGround : ReferenceZ;
+
+	for (int32 Index = 0; Index < ChunkCells; ++Index)
+	{
+		Chunk.FuelEdges |= Chunk.Fuel[Index * ChunkCells] > 0.0f ? Edge_West : 0;
+		Chunk.FuelEdges |= Chunk.Fuel[Index * ChunkCells + ChunkCells - 1] > 0.0f ? Edge_East : 0;
+		Chunk.FuelEdges |= Chunk.Fuel[Index] > 0.0f ? Edge_South : 0;
+		Chunk.FuelEdges |= Chunk.Fuel[(ChunkCells - 1) * ChunkCells + Index] > 0.0f ? Edge_North : 0;
+	}
+
+	return ChunkIndex;
+}
+
+bool UFireGridSubsystem::IsFlammable(const FHitResult& Hit) const
+{
+	const AActor* Actor = Hit.GetActor();
+	if (Actor && Actor->ActorHasTag(FlammableTag)) return true;
+
+	const UPhysicalMaterial* Material = Hit.PhysMaterial.Get();
+	return Material && FlammableSurfaces.Contains(Material->SurfaceType);
+}
+
+void UFireGridSubsystem::Activate(int32 ChunkIndex)
+{
+	FChunk& Chunk = *Chunks[ChunkIndex];
+	if (Chunk.bActive) return;
+
+	Chunk.bActive = true;
+	Chunk.LastUpdateTime = GetWorld()->GetTimeSeconds();
+	ActiveChunks.Add(ChunkIndex);
+}
+
+void UFireGridSubsystem::WakeNeighbors(int32 ChunkIndex)
+{
+	const FChunk& Chunk = *Chunks[ChunkIndex];
+	for (int32 Side = 0; Side < 4; ++Side)
+	{
+		if (!(Chunk.BurningEdges & (1 << Side))) continue;
+
+		const int32 Neighbor = Chunk.Neighbors[Side];
+		if (Neighbor == INDEX_NONE)
+		{
+			QueueChunk(Chunk.Coord + FIntPoint(NeighborX[Side], NeighborY[Side]), Chunk.ReferenceZ);
+			continue;
+		}
+
+		// Rock or water across the edge stops the fire without keeping the neighbour awake
+		if (Chunks[Neighbor]->FuelEdges & (1 << (Side ^ 1)))
+		{
+			Activate(Neighbor);
+		}
+	}
+}
+
+void UFireGridSubsystem::QueueChunk(const FIntPoint& Coord, float ReferenceZ)
+{
+	if (!PendingChunks.ContainsByPredicate([&Coord](const TPair<FIntPoint, float>& Pending)
+	{
+		return Pending.Key == Coord;
+	}))
+	{
+		PendingChunks.Emplace(Coord, ReferenceZ);
+	}
+}
+
+const UFireGridSubsystem::FChunk* UFireGridSubsystem::FindCell(const FIntPoint& Cell, int32& OutCellIndex) const
+{
+	const FIntPoint Coord(FloorDiv(Cell.X, ChunkCells), FloorDiv(Cell.Y, ChunkCells));
+	const int32* ChunkIndex = ChunkIndices.Find(Coord);
+	if (!ChunkIndex) return nullptr;
+
+	OutCellIndex = (Cell.Y - Coord.Y * ChunkCells) * ChunkCells + Cell.X - Coord.X * ChunkCells;
+	return Chunks[*ChunkIndex].Get();
+}
+
+FIntPoint UFireGridSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize));
+}
@@ -0,0 +1,185 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Systems/FlyThroughTestSubsystem.h"
+
+#include "ZeldaLikeDemo.h"
+#include "Characters/MyCharacterBase.h"
+#include "Components/StreamingLookAheadComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "HAL/FileManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "WorldPartition/WorldPartitionSubsystem.h"
+
+namespace
+{
+	/** Side of the default square path */
+	constexpr double DefaultPathSide = 40000.0;
+}
+
+bool UFlyThroughTestSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	return FParse::Param(FCommandLine::Get(), TEXT("FlyThroughTest")) && Super::ShouldCreateSubsystem(Outer);
+}
+
+bool UFlyThroughTestSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UFlyThroughTestSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	const TCHAR* CommandLine = FCommandLine::Get();
+	FParse::Value(CommandLine, TEXT("FlyPath="), PathParam, false);
+	FParse::Value(CommandLine, TEXT("FlySpeed="), Speed);
+	FParse::Value(CommandLine, TEXT("FlyHitchMs="), HitchMs);
+	FParse::Value(CommandLine, TEXT("FlyMaxHitches="), MaxHitches);
+	Speed = FMath::Max(Speed, 1.0f);
+
+	Lines.Add(TEXT("Time,X,Y,Z,FrameMs,StreamingCompleted,UsedMB"));
+}
+
+TStatId UFlyThroughTestSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UFlyThroughTestSubsystem, STATGROUP_Tickables);
+}
+
+void UFlyThroughTestSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	if (bFinished) return;
+
+	AMyCharacterBase* Character = Cast<AMyCharacterBase>(UGameplayStatics::GetPlayerPawn(GetWorld(), 0));
+	if (!Character) return;
+
+	const UWorldPartitionSubsystem* WorldPartition = GetWorld()->GetSubsystem<UWorldPartitionSubsystem>();
+	const bool bStreamingCompleted = !WorldPartition || WorldPartition->IsAllStreamingCompleted();
+	const double Now = FPlatformTime::Seconds();
+
+	if (!bStarted)
+	{
+		// Hitches while the start area loads are not part of the flight
+		if (!bStreamingCompleted) return;
+
+		BuildPath(Character->GetActorLocation());
+		// The path is the only motion, the movement component would add its own on top
+		Character->GetCharacterMovement()->DisableMovement();
+		StartUsedMemory = FPlatformMemory::GetStats().UsedPhysical;
+		LastFrameTime = Now;
+		bStarted = true;
+
+		UE_LOG(LogZeldaLikeDemo, Display, TEXT("Fly-through: %d points at %.0f cm/s, hitches over %.0f ms"),
+		       Path.Num(), Speed, HitchMs);
+		return;
+	}
+
+	// Wall-clock frame time, the world delta may be clamped
+	const float FrameMs = static_cast<float>((Now - LastFrameTime) * 1000.0);
+	LastFrameTime = Now;
+	FlightTime += DeltaTime;
+	++NumFrames;
+
+	const uint64 UsedMemory = FPlatformMemory::GetStats().UsedPhysical;
+	PeakUsedMemory = FMath::Max(PeakUsedMemory, UsedMemory);
+	WorstFrameMs = FMath::Max(WorstFrameMs, FrameMs);
+
+	if (FrameMs > HitchMs)
+	{
+		++NumHitches;
+		NumStreamingHitches += !bStreamingCompleted;
+		UE_LOG(LogZeldaLikeDemo, Warning, TEXT("Fly-through hitch at %.1fs: %.1f ms%s"), FlightTime, FrameMs,
+		       bStreamingCompleted ? TEXT("") : TEXT(" while streaming"));
+	}
+
+	const FVector Location = Character->GetActorLocation();
+	Lines.Add(FString::Printf(TEXT("%.3f,%.0f,%.0f,%.0f,%.2f,%d,%.1f"), FlightTime, Location.X, Location.Y,
+	                          Location.Z, FrameMs, bStreamingCompleted, UsedMemory / 1048576.0));
+
+	if (!Fly(Character, DeltaTime))
+	{
+		Finish();
+	}
+}
+
+void UFlyThroughTestSubsystem::BuildPath(const FVector& Start)
+{
+	Path.Reset();
+	Path.Add(Start);
+
+	TArray<FString> Points;
+	PathParam.ParseIntoArray(Points, TEXT(";"));
+	for (const FString& Point : Points)
+	{
+		TArray<FString> Coords;
+		if (Point.ParseIntoArray(Coords, TEXT(",")) == 3)
+		{
+			Path.Emplace(FCString::Atod(*Coords[0]), FCString::Atod(*Coords[1]), FCString::Atod(*Coords[2]));
+		}
+	}
+
+	if (Path.Num() == 1)
+	{
+		Path.Add(Start + FVector(DefaultPathSide, 0.0, 0.0));
+		Path.Add(Start + FVector(DefaultPathSide, DefaultPathSide, 0.0));
+		Path.Add(Start + FVector(0.0, DefaultPathSide, 0.0));
+		Path.Add(Start);
+	}
+	NextPoint = 1;
+}
+
+bool UFlyThroughTestSubsystem::Fly(AMyCharacterBase* Character, float DeltaTime)
+{
+	if (!Path.IsValidIndex(NextPoint)) return false;
+
+	const FVector Location = Character->GetActorLocation();
+	const FVector ToPoint = Path[NextPoint] - Location;
+	const double Step = Speed * DeltaTime;
+	const FVector Direction = ToPoint.GetSafeNormal();
+
+	// Scripted, so collisions do not stop the flight
+	if (ToPoint.Size() <= Step)
+	{
+		Character->SetActorLocation(Path[NextPoint]);
+		++NextPoint;
+	}
+	else
+	{
+		Character->SetActorLocation(Location + Direction * Step);
+	}
+	if (Character->StreamingLookAhead)
+	{
+		Character->StreamingLookAhead->SetVelocityOverride(Direction * Speed);
+	}
+	return true;
+}
+
+void UFlyThroughTestSubsystem::Finish()
+{
+	bFinished = true;
+
+	const FString Directory = FPaths::ProfilingDir() / TEXT("FlyThrough");
+	IFileManager::Get().MakeDirectory(*Directory, true);
+	const FString FilePath = Directory / FString::Printf(
+		TEXT("FlyThrough-%s.csv"), *FDateTime::Now().ToString(TEXT("%Y%m%d-%H%M%S")));
+	if (FFileHelper::SaveStringArrayToFile(Lines, *FilePath))
+	{
+		UE_LOG(LogZeldaLikeDemo, Display, TEXT("Fly-through frames written to %s"), *FilePath);
+	}
+
+	const bool bFailed = NumHitches > MaxHitches;
+	UE_LOG(LogZeldaLikeDemo, Display,
+	       TEXT("Fly-through finished: %.1fs, %d frames, %d hitches (%d while streaming), worst %.1f ms, ")
+	       TEXT("used memory %.1f MB at start, %.1f MB peak"), FlightTime, NumFrames, NumHitches,
+	       NumStreamingHitches, WorstFrameMs, StartUsedMemory / 1048576.0, PeakUsedMemory / 1048576.0);
+	if (bFailed)
+	{
+		UE_LOG(LogZeldaLikeDemo, Error, TEXT("Fly-through had %d hitches, %d allowed"), NumHitches, MaxHitches);
+	}
+
+	FPlatformMisc::RequestExitWithStatus(false, bFailed ? 1 : 0, TEXT("UFlyThroughTestSubsystem"));
+}
@@ -0,0 +1,82 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Systems/GliderPoolSubsystem.h"
+
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/SkeletalMesh.h"
+
+USkeletalMeshComponent* UGliderPoolSubsystem::AcquireGlider(USkeletalMesh* Mesh)
+{
+	USkeletalMeshComponent* Glider = nullptr;
+
+	// Prefer a glider that already shows the right mesh, otherwise reuse any of them
+	const int32 MatchIndex = FreeGliders.IndexOfByPredicate([Mesh](const USkeletalMeshComponent* Free)
+	{
+		return Free && Free->GetSkeletalMeshAsset() == Mesh;
+	});
+	if (MatchIndex != INDEX_NONE)
+	{
+		Glider = FreeGliders[MatchIndex];
+		FreeGliders.RemoveAtSwap(MatchIndex);
+	}
+	else if (!FreeGliders.IsEmpty())
+	{
+		Glider = FreeGliders.Pop();
+		Glider->SetSkeletalMesh(Mesh);
+	}
+
+	if (!Glider)
+	{
+		AActor* Owner = GetOrSpawnPoolOwner();
+		if (!Owner) return nullptr;
+
+		Glider = NewObject<USkeletalMeshComponent>(Owner);
+		Glider->SetSkeletalMesh(Mesh);
+		Glider->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		Glider->SetVisibility(false);
+		Glider->SetComponentTickEnabled(false);
+		Glider->RegisterComponent();
+	}
+
+	return Glider;
+}
+
+void UGliderPoolSubsystem::ReleaseGlider(USkeletalMeshComponent* Glider)
+{
+	if (!Glider) return;
+
+	Glider->SetVisibility(false);
+	Glider->SetComponentTickEnabled(false);
+	Glider->DetachFromComponent(FDetachmentTransformRules::KeepWorldTransform);
+
+	if (FreeGliders.Num() < MaxFreeGliders)
+	{
+		FreeGliders.Add(Glider);
+	}
+	else
+	{
+		Glider->DestroyComponent();
+	}
+}
+
+void UGliderPoolSubsystem::Deinitialize()
+{
+	FreeGliders.Empty();
+	PoolOwner = nullptr;
+
+	Super::Deinitialize();
+}
+
+AActor* UGliderPoolSubsystem::GetOrSpawnPoolOwner()
+{
+	if (!PoolOwner)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.Name = TEXT("GliderPool");
+		SpawnParams.NameMode = FActorSpawnParameters::ESpawnActorNameMode::Requested;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		PoolOwner = GetWorld()->SpawnActor<AActor>(SpawnParams);
+	}
+	return PoolOwner;
+}
@@ -0,0 +1,245 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Systems/MeleeCombatSubsystem.h"
+
+#include "ZeldaLikeDemo.h"
+#include "Async/ParallelFor.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/Pawn.h"
+#include "GenericTeamAgentInterface.h"
+#include "Kismet/GameplayStatics.h"
+
+DECLARE_CYCLE_STAT(TEXT("Melee Combat"), STAT_MeleeCombat, STATGROUP_ZeldaLikeDemo);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Melee Sweeps"), STAT_MeleeSweeps, STATGROUP_ZeldaLikeDemo);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Melee Hits"), STAT_MeleeHits, STATGROUP_ZeldaLikeDemo);
+
+void UMeleeCombatSubsystem::BeginSwing(USkeletalMeshComponent* Mesh, const UObject* Source,
+                                       const FMeleeAttackParams& Params)
+{
+	if (!Mesh || !Mesh->GetOwner()) return;
+
+	// A window reopened before it closed, e.g. a looping montage, starts a new swing in the same slot
+	FSwing* Swing = Swings.FindByPredicate([Mesh, Source](const FSwing& Entry)
+	{
+		return Entry.Mesh == Mesh && Entry.Source == Source;
+	});
+	if (!Swing)
+	{
+		Swing = &Swings.AddDefaulted_GetRef();
+	}
+
+	Swing->Mesh = Mesh;
+	Swing->Source = Source;
+	Swing->Params = Params;
+	Swing->PreviousBase = Mesh->GetSocketLocation(Params.BaseSocket);
+	Swing->PreviousTip = Mesh->GetSocketLocation(Params.TipSocket);
+	Swing->HitActors.Reset();
+}
+
+void UMeleeCombatSubsystem::EndSwing(const USkeletalMeshComponent* Mesh, const UObject* Source)
+{
+	const int32 Index = Swings.IndexOfByPredicate([Mesh, Source](const FSwing& Entry)
+	{
+		return Entry.Mesh == Mesh && Entry.Source == Source;
+	});
+	if (Index != INDEX_NONE)
+	{
+		Swings.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	}
+}
+
+TStatId UMeleeCombatSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMeleeCombatSubsystem, STATGROUP_Tickables);
+}
+
+bool UMeleeCombatSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UMeleeCombatSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	SCOPE_CYCLE_COUNTER(STAT_MeleeCombat);
+
+	// Real time, hit-stop slows the actors down but not this subsystem
+	UpdateHitStops(GetWorld()->GetRealTimeSeconds());
+	if (Swings.IsEmpty()) return;
+
+	// Tickable subsystems run after the tick groups, so the sockets are at this frame's pose
+	Sweeps.Reset();
+	for (int32 Index = Swings.Num() - 1; Index >= 0; --Index)
+	{
+		if (!Swings[Index].Mesh.IsValid())
+		{
+			Swings.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+		}
+	}
+
+	for (int32 SwingIndex = 0; SwingIndex < Swings.Num(); ++SwingIndex)
+	{
+		FSwing& Swing = Swings[SwingIndex];
+		USkeletalMeshComponent* Mesh = Swing.Mesh.Get();
+		const FVector Base = Mesh->GetSocketLocation(Swing.Params.BaseSocket);
+		const FVector Tip = Mesh->GetSocketLocation(Swing.Params.TipSocket);
+
+		// A fast arc is split into substeps so the blade turns between sweeps, a single sweep would only move the
+		// current blade between both poses and miss what the tip passed through
+		const double TipTravel = FVector::Dist(Swing.PreviousTip, Tip);
+		const int32 NumSubsteps = FMath::Clamp(
+			FMath::CeilToInt32(TipTravel / FMath::Max(Swing.Params.Radius * 2.0f, 1.0f)), 1,
+			FMath::Max(MaxSweepSubsteps, 1));
+
+		FVector StepBase = Swing.PreviousBase;
+		FVector StepTip = Swing.PreviousTip;
+		for (int32 Step = 1; Step <= NumSubsteps; ++Step)
+		{
+			const double Alpha = static_cast<double>(Step) / NumSubsteps;
+			const FVector NextBase = FMath::Lerp(Swing.PreviousBase, Base, Alpha);
+			const FVector NextTip = FMath::Lerp(Swing.PreviousTip, Tip, Alpha);
+			const FVector Blade = NextTip - NextBase;
+			const double Length = Blade.Size();
+
+			// A capsule along the blade at the end of the substep, swept between the blade centers
+			FSweep& Sweep = Sweeps.AddDefaulted_GetRef();
+			Sweep.Start = (StepBase + StepTip) * 0.5;
+			Sweep.End = (NextBase + NextTip) * 0.5;
+			Sweep.Rotation = Length > UE_KINDA_SMALL_NUMBER
+				                 ? FRotationMatrix::MakeFromZ(Blade / Length).ToQuat()
+				                 : FQuat::Identity;
+			Sweep.HalfHeight = Length * 0.5 + Swing.Params.Radius;
+			Sweep.Radius = Swing.Params.Radius;
+			Sweep.Attacker = Mesh->GetOwner();
+			Sweep.SwingIndex = SwingIndex;
+
+			StepBase = NextBase;
+			StepTip = NextTip;
+		}
+
+		Swing.PreviousBase = Base;
+		Swing.PreviousTip = Tip;
+	}
+
+	RunSweeps();
+
+	// Substeps of a swing are in order, so a target is hit by the first substep that reached it
+	for (int32 Index = 0; Index < Sweeps.Num(); ++Index)
+	{
+		const FSweep& Sweep = Sweeps[Index];
+		FSwing& Swing = Swings[Sweep.SwingIndex];
+		const FVector SweepDirection = (Sweep.End - Sweep.Start).GetSafeNormal();
+		const FVector Direction = SweepDirection.IsZero() ? Sweep.Attacker->GetActorForwardVector() : SweepDirection;
+
+		for (const FHitResult& Hit : SweepHits[Index])
+		{
+			// One hit per target and swing, whichever of its components the blade touched first
+			AActor* Target = Hit.GetActor();
+			if (!Target || Target == Sweep.Attacker || Swing.HitActors.Contains(Target)) continue;
+			Swing.HitActors.Add(Target);
+
+			FPendingHit& Pending = PendingHits.AddDefaulted_GetRef();
+			Pending.Attacker = Sweep.Attacker;
+			Pending.Target = Target;
+			Pending.Hit = Hit;
+			Pending.Direction = Direction;
+			Pending.Damage = Swing.Params.Damage;
+			Pending.HitStopSeconds = Swing.Params.HitStopSeconds;
+			Pending.DamageType = Swing.Params.DamageType;
+		}
+	}
+
+	// Damage can kill an attacker and end its swing, so it is applied after the swings were resolved
+	ApplyHits();
+}
+
+void UMeleeCombatSubsystem::RunSweeps()
+{
+	const UWorld* World = GetWorld();
+	if (SweepHits.Num() < Sweeps.Num())
+	{
+		SweepHits.SetNum(Sweeps.Num());
+	}
+
+	FCollisionObjectQueryParams ObjectParams;
+	ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
+	ObjectParams.AddObjectTypesToQuery(ECC_PhysicsBody);
+
+	// Scene queries are read only, the sweeps of all attackers run side by side
+	ParallelFor(Sweeps.Num(), [this, World, &ObjectParams](int32 Index)
+	{
+		const FSweep& Sweep = Sweeps[Index];
+		TArray<FHitResult>& Hits = SweepHits[Index];
+		Hits.Reset();
+
+		const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(MeleeSweep), false, Sweep.Attacker);
+		World->SweepMultiByObjectType(Hits, Sweep.Start, Sweep.End, Sweep.Rotation, ObjectParams,
+		                              FCollisionShape::MakeCapsule(Sweep.Radius, Sweep.HalfHeight), QueryParams);
+	}, Sweeps.Num() < MinParallelSweeps ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+	INC_DWORD_STAT_BY(STAT_MeleeSweeps, Sweeps.Num());
+}
+
+void UMeleeCombatSubsystem::ApplyHits()
+{
+	const double Now = GetWorld()->GetRealTimeSeconds();
+	INC_DWORD_STAT_BY(STAT_MeleeHits, PendingHits.Num());
+
+	for (const FPendingHit& Pending : PendingHits)
+	{
+		AActor* Target = Pending.Target.Get();
+		if (!Target) continue;
+
+		AActor* Attacker = Pending.Attacker.Get();
+
+		// Allies do not hurt each other, a hit enemy would otherwise turn on whoever hit it
+		const FGenericTeamId AttackerTeam = FGenericTeamId::GetTeamIdentifier(Attacker);
+		if (AttackerTeam != FGenericTeamId::NoTeam && AttackerTeam == FGenericTeamId::GetTeamIdentifier(Target))
+			continue;
+
+		if (Pending.HitStopSeconds > 0.0f)
+		{
+			StartHitStop(Target, Now + Pending.HitStopSeconds);
+			if (Attacker)
+			{
+				StartHitStop(Attacker, Now + Pending.HitStopSeconds);
+			}
+		}
+
+		const APawn* AttackerPawn = Cast<APawn>(Attacker);
+		UGameplayStatics::ApplyPointDamage(Target, Pending.Damage, Pending.Direction, Pending.Hit,
+		                                   AttackerPawn ? AttackerPawn->GetController() : nullptr, Attacker,
+		                                   Pending.DamageType);
+	}
+
+	PendingHits.Reset();
+}
+
+void UMeleeCombatSubsystem::StartHitStop(AActor* Actor, double EndTime)
+{
+	FHitStop* HitStop = HitStops.FindByPredicate([Actor](const FHitStop& Entry) { return Entry.Actor == Actor; });
+	if (HitStop)
+	{
+		HitStop->EndTime = FMath::Max(HitStop->EndTime, EndTime);
+		return;
+	}
+
+	HitStops.Add({Actor, EndTime});
+	Actor->CustomTimeDilation = HitStopTimeDilation;
+}
+
+void UMeleeCombatSubsystem::UpdateHitStops(double Now)
+{
+	for (int32 Index = HitStops.Num() - 1; Index >= 0; --Index)
+	{
+		const FHitStop& HitStop = HitStops[Index];
+		if (Now < HitStop.EndTime && HitStop.Actor.IsValid()) continue;
+
+		if (AActor* Actor = HitStop.Actor.Get())
+		{
+			Actor->CustomTimeDilation = 1.0f;
+		}
+		HitStops.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	}
+}
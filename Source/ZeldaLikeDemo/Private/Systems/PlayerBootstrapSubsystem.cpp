@@ -0,0 +1,117 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Systems/PlayerBootstrapSubsystem.h"
+
+#include "ZeldaLikeDemo.h"
+#include "Data/PlayerBootstrapData.h"
+#include "Engine/AssetManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/CoreDelegates.h"
+
+namespace
+{
+	double SecondsSinceStart()
+	{
+		return FPlatformTime::Seconds() - GStartTime;
+	}
+}
+
+void UPlayerBootstrapSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	RequestedTime = SecondsSinceStart();
+
+	UAssetManager& AssetManager = UAssetManager::Get();
+	TArray<FPrimaryAssetId> AssetIds;
+	AssetManager.GetPrimaryAssetIdList(UPlayerBootstrapData::PrimaryAssetType, AssetIds);
+	if (AssetIds.IsEmpty())
+	{
+		UE_LOG(LogZeldaLikeDemo, Warning, TEXT("No %s asset registered, the player starts without bootstrap assets"),
+		       *UPlayerBootstrapData::PrimaryAssetType.ToString());
+		OnBundleLoaded();
+		return;
+	}
+
+	BootstrapId = AssetIds[0];
+	LoadHandle = AssetManager.LoadPrimaryAsset(BootstrapId, {UPlayerBootstrapData::BootstrapBundle},
+	                                           FStreamableDelegate::CreateUObject(
+		                                           this, &UPlayerBootstrapSubsystem::OnBundleLoaded),
+	                                           FStreamableManager::AsyncLoadHighPriority);
+
+	// No handle means there was nothing left to load
+	if (!LoadHandle.IsValid() || LoadHandle->HasLoadCompleted())
+	{
+		OnBundleLoaded();
+	}
+}
+
+void UPlayerBootstrapSubsystem::Deinitialize()
+{
+	FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+	OnLoaded.Clear();
+
+	if (LoadHandle.IsValid())
+	{
+		LoadHandle->ReleaseHandle();
+		LoadHandle.Reset();
+	}
+
+	Super::Deinitialize();
+}
+
+void UPlayerBootstrapSubsystem::CallOrRegister_OnBootstrapLoaded(FOnPlayerBootstrapLoaded::FDelegate&& Delegate)
+{
+	if (bLoaded)
+	{
+		Delegate.Execute(BootstrapData);
+	}
+	else
+	{
+		OnLoaded.Add(MoveTemp(Delegate));
+	}
+}
+
+void UPlayerBootstrapSubsystem::NotifyPlayerReady()
+{
+	if (bPlayerReady) return;
+
+	bPlayerReady = true;
+	ReadyTime = SecondsSinceStart();
+
+	// The player can act from the next frame that finishes
+	EndFrameHandle = FCoreDelegates::OnEndFrame.AddUObject(this, &UPlayerBootstrapSubsystem::OnFirstPlayableFrame);
+}
+
+void UPlayerBootstrapSubsystem::OnBundleLoaded()
+{
+	if (bLoaded) return;
+
+	bLoaded = true;
+	LoadedTime = SecondsSinceStart();
+
+	if (BootstrapId.IsValid())
+	{
+		BootstrapData = UAssetManager::Get().GetPrimaryAssetObject<UPlayerBootstrapData>(BootstrapId);
+	}
+
+	OnLoaded.Broadcast(BootstrapData);
+	OnLoaded.Clear();
+}
+
+void UPlayerBootstrapSubsystem::OnFirstPlayableFrame()
+{
+	FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+	EndFrameHandle.Reset();
+
+	const double FirstFrameTime = SecondsSinceStart();
+	UE_LOG(LogZeldaLikeDemo, Display,
+	       TEXT("Bootstrap timing: bundle requested %.3fs, bundle loaded %.3fs, player ready %.3fs, first playable frame %.3fs"),
+	       RequestedTime, LoadedTime, ReadyTime, FirstFrameTime);
+
+	if (FParse::Param(FCommandLine::Get(), TEXT("ExitAfterFirstPlayableFrame")))
+	{
+		FPlatformMisc::RequestExit(false, TEXT("UPlayerBootstrapSubsystem"));
+	}
+}
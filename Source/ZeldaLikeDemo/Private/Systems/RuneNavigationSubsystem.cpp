@@ -0,0 +1,342 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Systems/RuneNavigationSubsystem.h"
+
+#include "ZeldaLikeDemo.h"
+#include "Components/PrimitiveComponent.h"
+#include "Kismet/GameplayStatics.h"
+#include "NavigationSystem.h"
+#include "NavMesh/RecastNavMesh.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Nav Tiles Waiting"), STAT_NavTilesWaiting, STATGROUP_ZeldaLikeDemo);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Nav Tiles Submitted"), STAT_NavTilesSubmitted, STATGROUP_ZeldaLikeDemo);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Nav Rune Actors Waiting"), STAT_NavRuneActorsWaiting, STATGROUP_ZeldaLikeDemo);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Nav Build Tasks Remaining"), STAT_NavBuildTasksRemaining, STATGROUP_ZeldaLikeDemo);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Nav Rebuild Latency (ms)"), STAT_NavRebuildLatency, STATGROUP_ZeldaLikeDemo);
+
+CSV_DEFINE_CATEGORY(RuneNavigation, true);
+
+const FName URuneNavigationSubsystem::NavigationGeometryTag(TEXT("RuneNavGeometry"));
+
+void URuneNavigationSubsystem::Tick(float DeltaTime)
+{
+	UWorld* World = GetWorld();
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(World);
+	if (!NavSys) return;
+
+	const double Now = World->GetTimeSeconds();
+
+	// Latency from the first change of a tile until the navmesh finished rebuilding it
+	const bool bBuilding = NavSys->HasDirtyAreasQueued() || NavSys->IsNavigationBuildInProgress();
+	if (OldestInFlightTime >= 0.0 && !bBuilding)
+	{
+		const float LatencyMs = static_cast<float>((Now - OldestInFlightTime) * 1000.0);
+		SET_FLOAT_STAT(STAT_NavRebuildLatency, LatencyMs);
+		CSV_CUSTOM_STAT(RuneNavigation, RebuildLatencyMs, LatencyMs, ECsvCustomStatOp::Max);
+		OldestInFlightTime = -1.0;
+	}
+
+	INC_DWORD_STAT_BY(STAT_NavTilesWaiting, DirtyTiles.Num());
+	INC_DWORD_STAT_BY(STAT_NavRuneActorsWaiting, GeometryChanges.Num());
+	INC_DWORD_STAT_BY(STAT_NavBuildTasksRemaining, NavSys->GetNumRemainingBuildTasks());
+	CSV_CUSTOM_STAT(RuneNavigation, TilesWaiting, DirtyTiles.Num(), ECsvCustomStatOp::Set);
+
+	if (DirtyTiles.IsEmpty()) return;
+
+	int32 NumSubmitted = 0;
+
+	// Rune actors first, oldest first. Making an actor relevant or destroying it has the engine dirty its bounds,
+	// which covers all of its tiles in one go
+	for (int32 Index = 0; Index < GeometryChanges.Num() && NumSubmitted < MaxTilesPerFrame;)
+	{
+		if (GeometryChanges[Index].Actor.IsValid())
+		{
+			if (!IsChangeDue(GeometryChanges[Index], Now))
+			{
+				++Index;
+				continue;
+			}
+
+			// An actor wider than the cap still goes through, alone in its frame
+			if (NumSubmitted > 0 && NumSubmitted + GeometryChanges[Index].Tiles.Num() > MaxTilesPerFrame) break;
+		}
+
+		// Taken out first, destroying the actor may despawn other rune actors
+		const FGeometryChange Change = MoveTemp(GeometryChanges[Index]);
+		GeometryChanges.RemoveAt(Index, 1, EAllowShrinking::No);
+
+		AActor* Actor = Change.Actor.Get();
+		if (!Actor)
+		{
+			// Never reached the navmesh, or the engine dirtied its tiles when it went
+			ReleaseTiles(Change, false);
+			continue;
+		}
+
+		for (const FIntPoint& Tile : Change.Tiles)
+		{
+			const double MarkTime = DirtyTiles.FindChecked(Tile).Time;
+			OldestInFlightTime = OldestInFlightTime < 0.0 ? MarkTime : FMath::Min(OldestInFlightTime, MarkTime);
+		}
+		ReleaseTiles(Change, true);
+		NumSubmitted += Change.Tiles.Num();
+
+		if (Change.bRemove)
+		{
+			Actor->Destroy();
+		}
+		else
+		{
+			for (const TWeakObjectPtr<UPrimitiveComponent>& Component : Change.Components)
+			{
+				if (Component.IsValid())
+				{
+					Component->SetCanEverAffectNavigation(true);
+				}
+			}
+		}
+	}
+
+	DueTiles.Reset();
+	for (const TPair<FIntPoint, FDirtyTile>& Tile : DirtyTiles)
+	{
+		// Tiles a rune actor waits on go with the actor
+		if (Tile.Value.NumChanges == 0 && Now - Tile.Value.Time >= CoalesceSeconds)
+		{
+			DueTiles.Emplace(Tile.Value.Time, Tile.Key);
+		}
+	}
+
+	const float TileSize = GetTileSize();
+	const int32 NumTiles = FMath::Min(DueTiles.Num(), MaxTilesPerFrame - NumSubmitted);
+
+	// Tiles near the player matter first for pathing enemies around them
+	if (DueTiles.Num() > NumTiles)
+	{
+		if (const APawn* Player = UGameplayStatics::GetPlayerPawn(World, 0))
+		{
+			const FVector2D PlayerTile = FVector2D(Player->GetActorLocation()) / TileSize;
+			DueTiles.Sort([&PlayerTile](const TPair<double, FIntPoint>& A, const TPair<double, FIntPoint>& B)
+			{
+				return FVector2D::DistSquared(FVector2D(A.Value), PlayerTile) <
+					FVector2D::DistSquared(FVector2D(B.Value), PlayerTile);
+			});
+		}
+	}
+
+	// Max edges stop short of the next tile, the navmesh would otherwise rebuild the +X and +Y neighbours too
+	constexpr double TileEdgeInset = 1.0;
+	for (int32 Index = 0; Index < NumTiles; ++Index)
+	{
+		const FIntPoint Tile = DueTiles[Index].Value;
+		const FBox TileBounds(FVector(Tile.X * TileSize, Tile.Y * TileSize, -HALF_WORLD_MAX),
+		                      FVector((Tile.X + 1) * TileSize - TileEdgeInset, (Tile.Y + 1) * TileSize - TileEdgeInset,
+		                              HALF_WORLD_MAX));
+		NavSys->AddDirtyArea(TileBounds, ENavigationDirtyFlag::All, TEXT("RuneGeometry"));
+
+		OldestInFlightTime = OldestInFlightTime < 0.0
+			                     ? DueTiles[Index].Key
+			                     : FMath::Min(OldestInFlightTime, DueTiles[Index].Key);
+		DirtyTiles.Remove(Tile);
+	}
+	INC_DWORD_STAT_BY(STAT_NavTilesSubmitted, NumSubmitted + NumTiles);
+}
+
+TStatId URuneNavigationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(URuneNavigationSubsystem, STATGROUP_Tickables);
+}
+
+AActor* URuneNavigationSubsystem::SpawnRuneActor(TSubclassOf<AActor> ActorClass, const FTransform& Transform,
+                                                 APawn* SpawnInstigator)
+{
+	if (!ActorClass) return nullptr;
+
+	AActor* Actor = GetWorld()->SpawnActorDeferred<AActor>(
+		ActorClass, Transform, SpawnInstigator, SpawnInstigator,
+		ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn);
+	if (!Actor) return nullptr;
+
+	FGeometryChange Change;
+	Change.Actor = Actor;
+
+	// Native components are not registered yet, switched off now they do not dirty anything when they are
+	for (UPrimitiveComponent* Component : TInlineComponentArray<UPrimitiveComponent*>(Actor))
+	{
+		if (Component->CanEverAffectNavigation())
+		{
+			Component->SetCanEverAffectNavigation(false);
+			Change.Components.Add(Component);
+		}
+	}
+
+	Actor->FinishSpawning(Transform);
+	if (!IsValid(Actor)) return nullptr;
+
+	// Blueprint components were created and registered while spawning finished
+	FBox Bounds(ForceInit);
+	for (UPrimitiveComponent* Component : TInlineComponentArray<UPrimitiveComponent*>(Actor))
+	{
+		if (Change.Components.Contains(Component))
+		{
+			Bounds += Component->Bounds.GetBox();
+		}
+		else if (Component->CanEverAffectNavigation())
+		{
+			UE_LOG(LogZeldaLikeDemo, Warning,
+			       TEXT("%s dirties the navmesh by itself, turn off Can Ever Affect Navigation and tag it %s"),
+			       *Component->GetPathName(), *NavigationGeometryTag.ToString());
+		}
+		else if (Component->ComponentHasTag(NavigationGeometryTag))
+		{
+			Change.Components.Add(Component);
+			Bounds += Component->Bounds.GetBox();
+		}
+	}
+
+	// Bombs and other actors without navigation geometry
+	if (!Change.Components.IsEmpty())
+	{
+		QueueGeometryChange(MoveTemp(Change), Bounds);
+	}
+	return Actor;
+}
+
+void URuneNavigationSubsystem::DespawnRuneActor(AActor* Actor)
+{
+	if (!Actor) return;
+
+	const int32 Index = GeometryChanges.IndexOfByPredicate([Actor](const FGeometryChange& Entry)
+	{
+		return Entry.Actor == Actor;
+	});
+	if (Index != INDEX_NONE)
+	{
+		// Already leaving
+		if (GeometryChanges[Index].bRemove) return;
+
+		// Never reached the navmesh, there is nothing to rebuild
+		ReleaseTiles(GeometryChanges[Index], false);
+		GeometryChanges.RemoveAt(Index);
+		Actor->Destroy();
+		return;
+	}
+
+	FBox Bounds(ForceInit);
+	for (const UPrimitiveComponent* Component : TInlineComponentArray<UPrimitiveComponent*>(Actor))
+	{
+		if (Component->CanEverAffectNavigation())
+		{
+			Bounds += Component->Bounds.GetBox();
+		}
+	}
+	if (!Bounds.IsValid)
+	{
+		Actor->Destroy();
+		return;
+	}
+
+	FGeometryChange Change;
+	Change.Actor = Actor;
+	Change.bRemove = true;
+	QueueGeometryChange(MoveTemp(Change), Bounds);
+}
+
+void URuneNavigationSubsystem::NotifyNavigationChanged(const FBox& Bounds)
+{
+	if (!Bounds.IsValid) return;
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	ForEachTile(Bounds, [this, Now](const FIntPoint& Tile)
+	{
+		// Keep the first time so latency covers the whole window
+		FDirtyTile* Dirty = DirtyTiles.Find(Tile);
+		if (!Dirty)
+		{
+			Dirty = &DirtyTiles.Add(Tile, {Now});
+		}
+		Dirty->bMarked = true;
+	});
+}
+
+void URuneNavigationSubsystem::NotifyActorNavigationChanged(AActor* Actor)
+{
+	if (!Actor) return;
+
+	NotifyNavigationChanged(Actor->GetComponentsBoundingBox(true));
+}
+
+bool URuneNavigationSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+float URuneNavigationSubsystem::GetTileSize() const
+{
+	const UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	const ARecastNavMesh* NavMesh = NavSys ? Cast<ARecastNavMesh>(NavSys->GetDefaultNavDataInstance()) : nullptr;
+	return NavMesh ? NavMesh->GetTileSizeUU() : 1000.0f;
+}
+
+void URuneNavigationSubsystem::ForEachTile(const FBox& Bounds, TFunctionRef<void(const FIntPoint&)> Visit) const
+{
+	const float TileSize = GetTileSize();
+	const int32 MinX = FMath::FloorToInt32(Bounds.Min.X / TileSize);
+	const int32 MinY = FMath::FloorToInt32(Bounds.Min.Y / TileSize);
+	const int32 MaxX = FMath::FloorToInt32(Bounds.Max.X / TileSize);
+	const int32 MaxY = FMath::FloorToInt32(Bounds.Max.Y / TileSize);
+	for (int32 X = MinX; X <= MaxX; ++X)
+	{
+		for (int32 Y = MinY; Y <= MaxY; ++Y)
+		{
+			Visit(FIntPoint(X, Y));
+		}
+	}
+}
+
+void URuneNavigationSubsystem::QueueGeometryChange(FGeometryChange&& Change, const FBox& Bounds)
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+	ForEachTile(Bounds, [this, Now, &Change](const FIntPoint& Tile)
+	{
+		FDirtyTile* Dirty = DirtyTiles.Find(Tile);
+		if (!Dirty)
+		{
+			Dirty = &DirtyTiles.Add(Tile, {Now});
+		}
+		++Dirty->NumChanges;
+		Change.Tiles.Add(Tile);
+	});
+	GeometryChanges.Add(MoveTemp(Change));
+}
+
+void URuneNavigationSubsystem::ReleaseTiles(const FGeometryChange& Change, bool bRebuilt)
+{
+	for (const FIntPoint& Tile : Change.Tiles)
+	{
+		FDirtyTile* Dirty = DirtyTiles.Find(Tile);
+		if (!Dirty) continue;
+
+		--Dirty->NumChanges;
+		if (bRebuilt)
+		{
+			// The dirty bounds of the actor cover the whole tile, including what NotifyNavigationChanged marked
+			Dirty->bMarked = false;
+		}
+		if (Dirty->NumChanges <= 0 && !Dirty->bMarked)
+		{
+			DirtyTiles.Remove(Tile);
+		}
+	}
+}
+
+bool URuneNavigationSubsystem::IsChangeDue(const FGeometryChange& Change, double Now) const
+{
+	for (const FIntPoint& Tile : Change.Tiles)
+	{
+		const FDirtyTile* Dirty = DirtyTiles.Find(Tile);
+		if (Dirty && Now - Dirty->Time < CoalesceSeconds) return false;
+	}
+	return true;
+}
@@ -0,0 +1,256 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Systems/SoakTestSubsystem.h"
+
+#include "EngineUtils.h"
+#include "ZeldaLikeDemo.h"
+#include "Actors/WindTunnel.h"
+#include "Characters/MyCharacterBase.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+
+namespace
+{
+	/** Length of one scripted input cycle (in seconds) */
+	constexpr double DriveCycle = 40.0;
+
+	/** Simulated time between two temporary wind tunnel spawns (in seconds) */
+	constexpr double WindTunnelInterval = 120.0;
+
+	/** A temporary wind tunnel still alive this long after spawning has leaked (in seconds) */
+	constexpr float WindTunnelLeakAge = 35.0f;
+}
+
+bool USoakTestSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	return FParse::Param(FCommandLine::Get(), TEXT("SoakTest")) && Super::ShouldCreateSubsystem(Outer);
+}
+
+bool USoakTestSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void USoakTestSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	const TCHAR* CommandLine = FCommandLine::Get();
+	FParse::Value(CommandLine, TEXT("SoakStep="), Step);
+	Step = FMath::Max(Step, UE_KINDA_SMALL_NUMBER);
+
+	double Hours = Duration / 3600.0;
+	FParse::Value(CommandLine, TEXT("SoakHours="), Hours);
+	Duration = Hours * 3600.0;
+
+	FParse::Value(CommandLine, TEXT("SoakCheckInterval="), CheckInterval);
+	FParse::Value(CommandLine, TEXT("SoakMaxObjectGrowth="), MaxObjectGrowth);
+
+	int64 MaxMemoryGrowthMB = MaxMemoryGrowthBytes / (1024 * 1024);
+	FParse::Value(CommandLine, TEXT("SoakMaxMemoryGrowthMB="), MaxMemoryGrowthMB);
+	MaxMemoryGrowthBytes = MaxMemoryGrowthMB * 1024 * 1024;
+
+	// Every frame advances the world by exactly one step and nothing waits for wall-clock time
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(Step);
+	GEngine->bUseFixedFrameRate = false;
+	GEngine->bSmoothFrameRate = false;
+	if (IConsoleVariable* MaxFPS = IConsoleManager::Get().FindConsoleVariable(TEXT("t.MaxFPS")))
+	{
+		MaxFPS->Set(0.0f);
+	}
+
+	NextCheckTime = CheckInterval;
+	NextWindTunnelTime = WindTunnelInterval;
+	StartWallTime = FPlatformTime::Seconds();
+
+	UE_LOG(LogZeldaLikeDemo, Display, TEXT("Soak test: step %.4fs, %.1f simulated hours, checks every %.0fs"), Step,
+	       Hours, CheckInterval);
+}
+
+TStatId USoakTestSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USoakTestSubsystem, STATGROUP_Tickables);
+}
+
+void USoakTestSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	if (bFinished) return;
+
+	if (AMyCharacterBase* Character = Cast<AMyCharacterBase>(UGameplayStatics::GetPlayerPawn(GetWorld(), 0)))
+	{
+		DrivePlayer(Character);
+	}
+
+	SimulatedTime += DeltaTime;
+
+	if (SimulatedTime >= NextCheckTime)
+	{
+		NextCheckTime += CheckInterval;
+		RunChecks();
+	}
+
+	if (SimulatedTime >= Duration)
+	{
+		Finish();
+	}
+}
+
+void USoakTestSubsystem::DrivePlayer(AMyCharacterBase* Character)
+{
+	const double PreviousCycleTime = FMath::Fmod(SimulatedTime, DriveCycle);
+	const double CycleTime = PreviousCycleTime + Step;
+	auto Crossed = [PreviousCycleTime, CycleTime](double Time)
+	{
+		return PreviousCycleTime < Time && CycleTime >= Time;
+	};
+
+	// Walk in a slow circle so the player stays around the start
+	if (CycleTime < 30.0)
+	{
+		const FRotator Heading(0.0f, static_cast<float>(FMath::Fmod(SimulatedTime * 10.0, 360.0)), 0.0f);
+		Character->AddMovementInput(Heading.Vector(), 1.0f);
+	}
+
+	// Mirror the conditions of the input handlers, which cannot be called without input events
+	if (Crossed(10.0) && (Character->CurrentMT == EMovementTypes::MM_WALKING || Character->CurrentMT ==
+		EMovementTypes::MM_MAX))
+	{
+		Character->LocomotionManager(EMovementTypes::MM_SPRINTING);
+	}
+
+	if (Crossed(20.0) && Character->CurrentMT != EMovementTypes::MM_EXHAUSTED && !Character->GetCharacterMovement()->
+		IsFalling())
+	{
+		Character->PreviousMT = Character->CurrentMT;
+		Character->Jump();
+		Character->LocomotionManager(EMovementTypes::MM_FALLING);
+	}
+
+	if (Crossed(20.4) && Character->CurrentMT == EMovementTypes::MM_FALLING)
+	{
+		Character->LocomotionManager(EMovementTypes::MM_GLIDING);
+	}
+
+	if (Crossed(20.5))
+	{
+		Character->StopJumping();
+	}
+
+	if (Crossed(30.0) && Character->CurrentMT == EMovementTypes::MM_SPRINTING)
+	{
+		Character->LocomotionManager(EMovementTypes::MM_WALKING);
+	}
+
+	// Temporary wind tunnels must destroy themselves
+	if (SimulatedTime >= NextWindTunnelTime)
+	{
+		NextWindTunnelTime += WindTunnelInterval;
+
+		const FTransform SpawnTransform(Character->GetActorLocation());
+		if (AWindTunnel* WindTunnel = GetWorld()->SpawnActorDeferred<AWindTunnel>(
+			AWindTunnel::StaticClass(), SpawnTransform, nullptr, nullptr,
+			ESpawnActorCollisionHandlingMethod::AlwaysSpawn))
+		{
+			WindTunnel->bTemporaryWT = true;
+			WindTunnel->FinishSpawning(SpawnTransform);
+		}
+	}
+}
+
+void USoakTestSubsystem::RunChecks()
+{
+	UWorld* World = GetWorld();
+	FTimerManager& TimerManager = World->GetTimerManager();
+	++NumChecks;
+
+	const int32 NumObjects = GUObjectArray.GetObjectArrayNumMinusAvailable();
+	const uint64 UsedMemory = FPlatformMemory::GetStats().UsedPhysical;
+
+	int32 NumWindTunnels = 0;
+	for (TActorIterator<AWindTunnel> It(World); It; ++It)
+	{
+		++NumWindTunnels;
+		if (It->bTemporaryWT && It->GetGameTimeSinceCreation() > WindTunnelLeakAge)
+		{
+			Fail(FString::Printf(TEXT("temporary wind tunnel %s alive for %.0fs"), *It->GetName(),
+			                     It->GetGameTimeSinceCreation()));
+		}
+	}
+
+	int32 NumCharacterTimers = 0;
+	for (TActorIterator<AMyCharacterBase> It(World); It; ++It)
+	{
+		const AMyCharacterBase* Character = *It;
+		const bool bDraining = TimerManager.IsTimerActive(Character->DrainStaminaTimerHandle);
+		const bool bRecovering = TimerManager.IsTimerActive(Character->RecoverStaminaTimerHandle);
+		NumCharacterTimers += bDraining + bRecovering +
+			TimerManager.IsTimerActive(Character->ReleaseParachuteTimerHandle);
+
+		if (bDraining && bRecovering)
+		{
+			Fail(FString::Printf(TEXT("%s drains and recovers stamina at once"), *Character->GetName()));
+		}
+
+		if (Character->CurrentStamina < 0.0f || Character->CurrentStamina > Character->MaxStamina)
+		{
+			Fail(FString::Printf(TEXT("%s stamina %.2f out of range"), *Character->GetName(),
+			                     Character->CurrentStamina));
+		}
+
+		if (Character->CurrentMT == EMovementTypes::MM_WALKING && Character->CurrentStamina < Character->MaxStamina
+			&& !bRecovering)
+		{
+			Fail(FString::Printf(TEXT("%s walks with %.2f stamina but is not recovering"), *Character->GetName(),
+			                     Character->CurrentStamina));
+		}
+	}
+
+	if (BaselineObjects == INDEX_NONE)
+	{
+		// The first check runs after warming up, later growth is what matters
+		BaselineObjects = NumObjects;
+		BaselineMemory = UsedMemory;
+	}
+	else
+	{
+		if (NumObjects - BaselineObjects > MaxObjectGrowth)
+		{
+			Fail(FString::Printf(TEXT("object count grew from %d to %d"), BaselineObjects, NumObjects));
+		}
+
+		if (UsedMemory > BaselineMemory && static_cast<int64>(UsedMemory - BaselineMemory) > MaxMemoryGrowthBytes)
+		{
+			Fail(FString::Printf(TEXT("used memory grew from %.1f MB to %.1f MB"), BaselineMemory / 1048576.0,
+			                     UsedMemory / 1048576.0));
+		}
+	}
+
+	const double WallTime = FPlatformTime::Seconds() - StartWallTime;
+	UE_LOG(LogZeldaLikeDemo, Display,
+	       TEXT("Soak %.0fs: objects %d, wind tunnels %d, character timers %d, used memory %.1f MB, %.1fx real time"),
+	       SimulatedTime, NumObjects, NumWindTunnels, NumCharacterTimers,
+	       UsedMemory / 1048576.0, WallTime > 0.0 ? SimulatedTime / WallTime : 0.0);
+}
+
+void USoakTestSubsystem::Fail(const FString& Message)
+{
+	++NumFailures;
+	UE_LOG(LogZeldaLikeDemo, Error, TEXT("Soak check failed at %.0fs: %s"), SimulatedTime, *Message);
+}
+
+void USoakTestSubsystem::Finish()
+{
+	bFinished = true;
+
+	const double WallTime = FPlatformTime::Seconds() - StartWallTime;
+	UE_LOG(LogZeldaLikeDemo, Display, TEXT("Soak test finished: %.1f simulated hours in %.1f minutes, %d checks, %d failures"),
+	       SimulatedTime / 3600.0, WallTime / 60.0, NumChecks, NumFailures);
+
+	FPlatformMisc::RequestExitWithStatus(false, NumFailures > 0 ? 1 : 0, TEXT("USoakTestSubsystem"));
+}
@@ -0,0 +1,54 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Systems/TelemetrySubsystem.h"
+
+#include "ZeldaLikeDemo.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+void UTelemetrySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	if (FParse::Param(FCommandLine::Get(), TEXT("NoTelemetry"))) return;
+
+	const FDateTime Now = FDateTime::UtcNow();
+	LogPath = FPaths::ProjectSavedDir() / TEXT("Telemetry") /
+		FString::Printf(TEXT("Session-%s.zlt"), *Now.ToString(TEXT("%Y%m%d-%H%M%S")));
+	SessionStartSeconds = FPlatformTime::Seconds();
+
+	if (Log.Open(LogPath, MaxRecords, Now.ToUnixTimestamp()))
+	{
+		UE_LOG(LogZeldaLikeDemo, Log, TEXT("Recording telemetry to %s"), *LogPath);
+	}
+}
+
+void UTelemetrySubsystem::Deinitialize()
+{
+	if (Log.IsOpen())
+	{
+		UE_LOG(LogZeldaLikeDemo, Log, TEXT("Telemetry: %u events recorded, %u dropped"), Log.GetNumRecords(),
+		       Log.GetNumDropped());
+		Log.Close();
+
+		if (!SubjectNames.IsEmpty())
+		{
+			TArray<FString> Lines;
+			for (const TPair<uint32, FString>& Subject : SubjectNames)
+			{
+				Lines.Add(FString::Printf(TEXT("%u,%s"), Subject.Key, *Subject.Value));
+			}
+			FFileHelper::SaveStringArrayToFile(Lines, *(LogPath + TEXT(".names")));
+		}
+	}
+
+	Super::Deinitialize();
+}
+
+void UTelemetrySubsystem::SetSubjectName(uint32 Subject, const FString& Name)
+{
+	if (!Log.IsOpen()) return;
+
+	SubjectNames.Add(Subject, Name);
+}
@@ -0,0 +1,144 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Systems/WaterQuerySubsystem.h"
+
+#include "Actors/WaterRegion.h"
+#include "Components/BrushComponent.h"
+#include "ZeldaLikeDemo.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Water Cells Built"), STAT_WaterCellsBuilt, STATGROUP_ZeldaLikeDemo);
+
+namespace
+{
+	FBox GetRegionBounds(const AWaterRegion* Region)
+	{
+		const UBrushComponent* Brush = Region->GetBrushComponent();
+		return Brush ? Brush->Bounds.GetBox() : Region->GetComponentsBoundingBox(true);
+	}
+}
+
+void UWaterQuerySubsystem::RegisterWaterRegion(AWaterRegion* Region)
+{
+	if (!Region) return;
+
+	ForEachBucket(GetRegionBounds(Region), [this, Region](const FIntPoint& Key)
+	{
+		Buckets.FindOrAdd(Key).AddUnique(Region);
+	});
+	InvalidateRegion(Region);
+}
+
+void UWaterQuerySubsystem::UnregisterWaterRegion(AWaterRegion* Region)
+{
+	if (!Region) return;
+
+	ForEachBucket(GetRegionBounds(Region), [this, Region](const FIntPoint& Key)
+	{
+		if (TArray<TWeakObjectPtr<AWaterRegion>>* Regions = Buckets.Find(Key))
+		{
+			Regions->RemoveSingleSwap(Region);
+			if (Regions->IsEmpty())
+			{
+				Buckets.Remove(Key);
+			}
+		}
+	});
+	InvalidateRegion(Region);
+}
+
+FWaterSample UWaterQuerySubsystem::Query(const FVector& Location)
+{
+	const FIntPoint Key = ToKey(Location, CellSize);
+	if (const FWaterSample* Sample = Cells.Find(Key))
+	{
+		return *Sample;
+	}
+
+	if (Cells.Num() >= MaxCachedCells)
+	{
+		Cells.Reset();
+	}
+	INC_DWORD_STAT(STAT_WaterCellsBuilt);
+	return Cells.Add(Key, BuildCell(Key));
+}
+
+FWaterSample UWaterQuerySubsystem::QueryWater(const FVector& Location)
+{
+	return Query(Location);
+}
+
+FIntPoint UWaterQuerySubsystem::ToKey(const FVector& Location, float Size)
+{
+	return FIntPoint(FMath::FloorToInt32(Location.X / Size), FMath::FloorToInt32(Location.Y / Size));
+}
+
+FWaterSample UWaterQuerySubsystem::BuildCell(const FIntPoint& Cell) const
+{
+	FWaterSample Sample;
+
+	const FVector2D Center = (FVector2D(Cell) + 0.5) * CellSize;
+	const TArray<TWeakObjectPtr<AWaterRegion>>* Regions = Buckets.Find(ToKey(FVector(Center, 0.0), BucketSize));
+	if (!Regions) return Sample;
+
+	for (const TWeakObjectPtr<AWaterRegion>& WeakRegion : *Regions)
+	{
+		const AWaterRegion* Region = WeakRegion.Get();
+		if (!Region) continue;
+
+		const FBox Bounds = GetRegionBounds(Region);
+		if (!Region->EncompassesPoint(FVector(Center, Bounds.GetCenter().Z))) continue;
+
+		// The highest surface wins where regions overlap
+		if (!Sample.bHasWater || Bounds.Max.Z > Sample.SurfaceHeight)
+		{
+			Sample.SurfaceHeight = Bounds.Max.Z;
+			Sample.Flow = Region->FlowVelocity;
+		}
+		Sample.BottomHeight = Sample.bHasWater ? FMath::Min(Sample.BottomHeight, Bounds.Min.Z) : Bounds.Min.Z;
+		Sample.bHasWater = true;
+	}
+	return Sample;
+}
+
+void UWaterQuerySubsystem::InvalidateRegion(const AWaterRegion* Region)
+{
+	const FBox Bounds = GetRegionBounds(Region);
+	const FIntPoint Min = ToKey(Bounds.Min, CellSize);
+	const FIntPoint Max = ToKey(Bounds.Max, CellSize);
+
+	// Large regions touch more cells than are cached, walk the cache instead
+	if (int64(Max.X - Min.X + 1) * (Max.Y - Min.Y + 1) > Cells.Num())
+	{
+		for (auto It = Cells.CreateIterator(); It; ++It)
+		{
+			if (It.Key().X >= Min.X && It.Key().X <= Max.X && It.Key().Y >= Min.Y && It.Key().Y <= Max.Y)
+			{
+				It.RemoveCurrent();
+			}
+		}
+		return;
+	}
+
+	for (int32 X = Min.X; X <= Max.X; ++X)
+	{
+		for (int32 Y = Min.Y; Y <= Max.Y; ++Y)
+		{
+			Cells.Remove(FIntPoint(X, Y));
+		}
+	}
+}
+
+template <typename FunctorType>
+void UWaterQuerySubsystem::ForEachBucket(const FBox& Bounds, FunctorType&& Visitor)
+{
+	const FIntPoint Min = ToKey(Bounds.Min, BucketSize);
+	const FIntPoint Max = ToKey(Bounds.Max, BucketSize);
+	for (int32 X = Min.X; X <= Max.X; ++X)
+	{
+		for (int32 Y = Min.Y; Y <= Max.Y; ++Y)
+		{
+			Visitor(FIntPoint(X, Y));
+		}
+	}
+}
@@ -0,0 +1,48 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Systems/WindFieldSubsystem.h"
+
+#include "Actors/WindTunnel.h"
+#include "Systems/FireGridSubsystem.h"
+
+void UWindFieldSubsystem::RegisterWindTunnel(AWindTunnel* WindTunnel)
+{
+	if (!WindTunnel) return;
+
+	WindTunnels.AddUnique(WindTunnel);
+	++TunnelVersion;
+}
+
+void UWindFieldSubsystem::UnregisterWindTunnel(AWindTunnel* WindTunnel)
+{
+	if (WindTunnels.RemoveSingleSwap(WindTunnel) > 0)
+	{
+		++TunnelVersion;
+	}
+}
+
+uint32 UWindFieldSubsystem::GetVersion() const
+{
+	// Both only ever grow, so their sum changes whenever either does
+	const UFireGridSubsystem* FireGrid = GetWorld()->GetSubsystem<UFireGridSubsystem>();
+	return TunnelVersion + (FireGrid ? FireGrid->GetVersion() : 0);
+}
+
+FVector UWindFieldSubsystem::SampleLiftVelocity(const FVector& Location) const
+{
+	FVector Lift = FVector::ZeroVector;
+	for (const AWindTunnel* WindTunnel : WindTunnels)
+	{
+		if (WindTunnel && WindTunnel->IsLocationInside(Location))
+		{
+			Lift += WindTunnel->GetLiftVelocity();
+		}
+	}
+
+	if (const UFireGridSubsystem* FireGrid = GetWorld()->GetSubsystem<UFireGridSubsystem>())
+	{
+		Lift += FireGrid->SampleUpdraft(Location);
+	}
+	return Lift;
+}
@@ -0,0 +1,163 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Telemetry/TelemetryLog.h"
+
+#include "ZeldaLikeDemo.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <windows.h>
+#include "Windows/HideWindowsPlatformTypes.h"
+#elif PLATFORM_UNIX || PLATFORM_MAC
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#include "Misc/FileHelper.h"
+#endif
+
+FTelemetryLog::~FTelemetryLog()
+{
+	Close();
+}
+
+bool FTelemetryLog::Open(const FString& Path, uint32 Capacity, int64 SessionStartTime)
+{
+	Close();
+	if (Capacity == 0) return false;
+
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(Path), true);
+
+	const int64 Size = sizeof(Telemetry::FFileHeader) + static_cast<int64>(Capacity) * sizeof(Telemetry::FRecord);
+	View = MapFile(IFileManager::Get().ConvertToAbsolutePathForExternalAppForWrite(*Path), Size);
+	if (!View)
+	{
+		UE_LOG(LogZeldaLikeDemo, Warning, TEXT("Could not map telemetry log %s"), *Path);
+		return false;
+	}
+	ViewSize = Size;
+
+	Header = reinterpret_cast<Telemetry::FFileHeader*>(View);
+	Records = reinterpret_cast<Telemetry::FRecord*>(View + sizeof(Telemetry::FFileHeader));
+
+	FMemory::Memzero(*Header);
+	Header->Magic = Telemetry::FileMagic;
+	Header->Version = Telemetry::FileVersion;
+	Header->RecordSize = sizeof(Telemetry::FRecord);
+	Header->Capacity = Capacity;
+	Header->SessionStartTime = SessionStartTime;
+	return true;
+}
+
+void FTelemetryLog::Close()
+{
+	if (!View) return;
+
+	const int64 UsedSize = sizeof(Telemetry::FFileHeader) +
+		static_cast<int64>(Header->NumRecords) * sizeof(Telemetry::FRecord);
+	UnmapFile(UsedSize);
+
+	Header = nullptr;
+	Records = nullptr;
+	View = nullptr;
+	ViewSize = 0;
+}
+
+#if PLATFORM_WINDOWS
+uint8* FTelemetryLog::MapFile(const FString& Path, int64 Size)
+{
+	FileHandle = CreateFileW(*Path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+	                         FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (FileHandle == INVALID_HANDLE_VALUE)
+	{
+		FileHandle = nullptr;
+		return nullptr;
+	}
+
+	// Mapping past the end of the file grows it to Size
+	LARGE_INTEGER MappingSize;
+	MappingSize.QuadPart = Size;
+	MappingHandle = CreateFileMappingW(FileHandle, nullptr, PAGE_READWRITE, MappingSize.HighPart,
+	                                   MappingSize.LowPart, nullptr);
+	void* Mapped = MappingHandle ? MapViewOfFile(MappingHandle, FILE_MAP_WRITE, 0, 0, Size) : nullptr;
+	if (!Mapped)
+	{
+		UnmapFile(0);
+		return nullptr;
+	}
+	return static_cast<uint8*>(Mapped);
+}
+
+void FTelemetryLog::UnmapFile(int64 Size)
+{
+	if (View)
+	{
+		UnmapViewOfFile(View);
+	}
+	if (MappingHandle)
+	{
+		CloseHandle(MappingHandle);
+		MappingHandle = nullptr;
+	}
+	if (FileHandle)
+	{
+		LARGE_INTEGER End;
+		End.QuadPart = Size;
+		SetFilePointerEx(FileHandle, End, nullptr, FILE_BEGIN);
+		SetEndOfFile(FileHandle);
+		CloseHandle(FileHandle);
+		FileHandle = nullptr;
+	}
+}
+#elif PLATFORM_UNIX || PLATFORM_MAC
+uint8* FTelemetryLog::MapFile(const FString& Path, int64 Size)
+{
+	FileDescriptor = open(TCHAR_TO_UTF8(*Path), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (FileDescriptor < 0) return nullptr;
+
+	if (ftruncate(FileDescriptor, Size) != 0)
+	{
+		UnmapFile(0);
+		return nullptr;
+	}
+
+	void* Mapped = mmap(nullptr, Size, PROT_READ | PROT_WRITE, MAP_SHARED, FileDescriptor, 0);
+	if (Mapped == MAP_FAILED)
+	{
+		UnmapFile(0);
+		return nullptr;
+	}
+	return static_cast<uint8*>(Mapped);
+}
+
+void FTelemetryLog::UnmapFile(int64 Size)
+{
+	if (View)
+	{
+		munmap(View, ViewSize);
+	}
+	if (FileDescriptor >= 0)
+	{
+		ftruncate(FileDescriptor, Size);
+		close(FileDescriptor);
+		FileDescriptor = -1;
+	}
+}
+#else
+uint8* FTelemetryLog::MapFile(const FString& Path, int64 Size)
+{
+	FallbackPath = Path;
+	return static_cast<uint8*>(FMemory::Malloc(Size));
+}
+
+void FTelemetryLog::UnmapFile(int64 Size)
+{
+	if (!View) return;
+
+	FFileHelper::SaveArrayToFile(TArrayView64<const uint8>(View, Size), *FallbackPath);
+	FMemory::Free(View);
+}
+#endif
@@ -0,0 +1,50 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ZeldaLikeDemo.h"
+#include "Commandlets/HotPathBenchmark.h"
+#include "Commandlets/HotPathBenchmarkCommandlet.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+BEGIN_DEFINE_SPEC(FHotPathBenchmarkSpec, "ZeldaLikeDemo.Perf.HotPath",
+                  EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+END_DEFINE_SPEC(FHotPathBenchmarkSpec)
+
+void FHotPathBenchmarkSpec::Define()
+{
+	// One test per row, each in a world of its own, with the budgets UHotPathBenchmarkCommandlet reads
+	for (const FName Name : HotPathBenchmark::GetNames())
+	{
+		It(Name.ToString(), [this, Name]()
+		{
+			const int64 Iterations = GetDefault<UHotPathBenchmarkCommandlet>()->Iterations;
+			TArray<HotPathBenchmark::FResult> Results;
+			if (!HotPathBenchmark::Run(Name.ToString(), Iterations, Results))
+			{
+				AddError(TEXT("Could not spawn the benchmark actors"));
+				return;
+			}
+			if (Results.IsEmpty())
+			{
+				AddError(FString::Printf(TEXT("%s did not run, its setup failed"), *Name.ToString()));
+				return;
+			}
+
+			const HotPathBenchmark::FResult& Result = Results[0];
+			AddInfo(FString::Printf(TEXT("%s: %.1f ns, %.3f allocations, %.3f traces per call over %lld calls"),
+			                        *Name.ToString(), Result.Nanoseconds, Result.Allocations, Result.Traces,
+			                        Result.Iterations));
+
+			TArray<FString> Errors;
+			HotPathBenchmark::CheckBudget(Result, Errors);
+			for (const FString& Error : Errors)
+			{
+				AddError(Error);
+			}
+		});
+	}
+}
+
+#endif
@@ -3,8 +3,15 @@
 
 #include "UI/RuneSelection.h"
 
+#include "Systems/TelemetrySubsystem.h"
+
 void URuneSelection::SelectRuneTypes(ERunes RuneType)
 {
 	if (!PlayerRef) return;
 	PlayerRef->ActiveRune = RuneType;
+
+	if (PlayerRef->Telemetry)
+	{
+		PlayerRef->Telemetry->Record(Telemetry::EEvent::RuneSelected, static_cast<uint8>(RuneType));
+	}
 }
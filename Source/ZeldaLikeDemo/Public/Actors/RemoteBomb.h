@@ -0,0 +1,37 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Systems/ExplosionFieldSubsystem.h"
+#include "RemoteBomb.generated.h"
+
+/**
+ * Bomb placed by the R_RBS and R_RBB runes.
+ * Detonating hands the blast to UExplosionFieldSubsystem, sets fire to flammable ground through
+ * UFireGridSubsystem and removes the bomb.
+ */
+UCLASS()
+class ZELDALIKEDEMO_API ARemoteBomb : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	ARemoteBomb();
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	UStaticMeshComponent* Mesh;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Explosion")
+	FExplosionParams Explosion;
+
+	/** Radius of grass and wood the blast sets on fire, 0 for none */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Explosion")
+	float IgniteRadius = 300.0f;
+
+	/** Blows the bomb up at its current location */
+	UFUNCTION(BlueprintCallable, Category = "Explosion")
+	void Detonate();
+};
@@ -0,0 +1,32 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/PhysicsVolume.h"
+#include "WaterRegion.generated.h"
+
+/**
+ * Body of water the player can swim in.
+ * A water physics volume, so the movement component swims inside it, that also registers its surface and flow with
+ * UWaterQuerySubsystem. The surface is the top of the volume.
+ */
+UCLASS()
+class ZELDALIKEDEMO_API AWaterRegion : public APhysicsVolume
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	AWaterRegion(const FObjectInitializer& ObjectInitializer);
+
+	/** Current that carries swimmers along (in cm/s) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Water")
+	FVector FlowVelocity{FVector::ZeroVector};
+
+protected:
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+};
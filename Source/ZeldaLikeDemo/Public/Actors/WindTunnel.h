@@ -26,10 +26,34 @@ public:
 	UPROPERTY(editAnywhere)
 	UBoxComponent* Box;
 
+	/** Speed the glider is pushed along the tunnel's up vector (in cm/s) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float LiftSpeed = 600.0f;
+
+	/**
+	 * Checks whether a world location is inside the tunnel volume.
+	 * @param Location - World location to test
+	 */
+	bool IsLocationInside(const FVector& Location) const;
+
+	/**
+	 * Gets the lift applied to a glider inside the tunnel.
+	 * @return Lift velocity in cm/s
+	 */
+	FVector GetLiftVelocity() const;
+
+	/** Id of the tunnel in telemetry records, stable across sessions for placed tunnels */
+	uint32 TelemetryId = 0;
+
+	/** World time the player entered the tunnel */
+	double PlayerEnterTime = 0.0;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
@@ -0,0 +1,31 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Animation/AnimNotifies/AnimNotifyState.h"
+#include "Systems/MeleeCombatSubsystem.h"
+#include "MeleeWindowNotifyState.generated.h"
+
+/**
+ * Active frames of a melee attack.
+ * Placed on attack montages over the frames where the blade deals damage. The window opens and closes a swing in
+ * UMeleeCombatSubsystem, which does the hit detection, so the attack timing is authored in the animation only.
+ */
+UCLASS(meta = (DisplayName = "Melee Window"))
+class ZELDALIKEDEMO_API UMeleeWindowNotifyState : public UAnimNotifyState
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Melee")
+	FMeleeAttackParams Attack;
+
+	virtual void NotifyBegin(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, float TotalDuration,
+	                         const FAnimNotifyEventReference& EventReference) override;
+
+	virtual void NotifyEnd(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation,
+	                       const FAnimNotifyEventReference& EventReference) override;
+
+	virtual FString GetNotifyName_Implementation() const override;
+};
@@ -38,6 +38,16 @@ public:
 
 	UPROPERTY(visibleanywhere, BlueprintReadOnly, Category = "References")
 	bool bReadyToThrow = false;
+
+	UPROPERTY(visibleanywhere, BlueprintReadOnly, Category = "References")
+	bool bIsClimbing = false;
+
+	UPROPERTY(visibleanywhere, BlueprintReadOnly, Category = "References")
+	bool bIsSwimming = false;
+
+	/** True while the attack montage plays, its Melee Window notify states time the hits */
+	UPROPERTY(visibleanywhere, BlueprintReadOnly, Category = "References")
+	bool bIsAttacking = false;
 	
 	
 	virtual void NativeInitializeAnimation() override;
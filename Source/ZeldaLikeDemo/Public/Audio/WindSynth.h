@@ -0,0 +1,80 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DSP/AlignedBuffer.h"
+#include "DSP/Filter.h"
+
+/**
+ * Mono procedural wind, lift and breathing synth.
+ * All three voices are filtered from one white noise buffer. Gains and envelopes change once per block and are
+ * applied with the vectorized array math of the SignalProcessing module, so the cost is a few passes over the
+ * block and does not depend on the parameter values. Voices that stay silent for a block are skipped.
+ * Has no engine audio dependencies, so it can be rendered without an audio device. Not thread safe.
+ */
+class ZELDALIKEDEMO_API FWindSynth
+{
+public:
+	/** Parameters sent by gameplay, all normalized to [0, 1] */
+	struct FParams
+	{
+		/** Glide or fall airspeed */
+		float Airspeed = 0.0f;
+
+		/** Wind tunnel lift at the listener */
+		float Lift = 0.0f;
+
+		/** Breathing effort, from sprinting on low stamina */
+		float Breath = 0.0f;
+	};
+
+	/**
+	 * Prepares the filters and buffers.
+	 * @param InSampleRate - Output sample rate
+	 * @param MaxBlockSize - Expected largest block, larger blocks grow the buffers once
+	 */
+	void Init(float InSampleRate, int32 MaxBlockSize = 1024);
+
+	/** Sets the parameters the voices glide toward over the next blocks */
+	void SetParams(const FParams& InParams) { Target = InParams; }
+
+	/**
+	 * Renders one block, replacing the content of the output.
+	 * @param OutAudio - Mono output samples
+	 * @param NumSamples - Number of samples to render
+	 */
+	void Generate(float* OutAudio, int32 NumSamples);
+
+private:
+	/** Fills the noise buffer with white noise in [-1, 1] */
+	void GenerateNoise(int32 NumSamples);
+
+	/** Filters the noise into the voice buffer and mixes it into the output with a linear gain ramp */
+	void MixVoice(Audio::FBiquadFilter& Filter, float StartGain, float EndGain, float* OutAudio, int32 NumSamples);
+
+	float SampleRate = 48000.0f;
+
+	uint32 NoiseState = 0x9E3779B9;
+
+	Audio::FBiquadFilter WindFilter;
+	Audio::FBiquadFilter LiftFilter;
+	Audio::FBiquadFilter BreathFilter;
+
+	Audio::FAlignedFloatBuffer Noise;
+	Audio::FAlignedFloatBuffer Voice;
+
+	FParams Target;
+
+	/** Smoothed parameters at the end of the previous block */
+	FParams Current;
+
+	/** Gains at the end of the previous block, start of the next ramp */
+	float WindGain = 0.0f;
+	float LiftGain = 0.0f;
+	float BreathGain = 0.0f;
+
+	/** Gust and breathing cycle phases (in radians) */
+	float GustPhase = 0.0f;
+	float BreathPhase = 0.0f;
+};
@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Small grid of wall probes around a climbing character.
+ * Cells are laid out on the plane of the wall and traced once. When the character moves into another cell, the
+ * grid shifts and only the cells that scrolled in are traced again, so climbing costs a few traces per cell crossed
+ * instead of several traces every frame.
+ */
+struct ZELDALIKEDEMO_API FClimbingSurfaceCache
+{
+	/** Cells on each side of the center, the grid is (2 * GridRadius + 1) cells wide and tall */
+	static constexpr int32 GridRadius = 2;
+	static constexpr int32 GridSize = GridRadius * 2 + 1;
+
+	/** Result of one probe */
+	struct FCell
+	{
+		/** Cell coordinates on the wall plane */
+		FIntPoint Coord{0, 0};
+		/** True if the probe hit a climbable surface */
+		bool bHit = false;
+		FVector ImpactPoint{FVector::ZeroVector};
+		FVector ImpactNormal{FVector::ZeroVector};
+	};
+
+	/** Cell edge length */
+	float CellSize = 50.0f;
+
+	/** Probes start this far in front of the wall plane */
+	float ProbeOffset = 60.0f;
+
+	/** Probes reach this far behind the wall plane */
+	float ProbeDepth = 60.0f;
+
+	/** Surfaces whose normal is steeper than this are climbable (absolute normal Z) */
+	float MaxClimbableNormalZ = 0.7f;
+
+	/** The grid is re-anchored when the center normal turns further than this from the plane (cosine) */
+	float ReanchorCosine = 0.85f;
+
+	/**
+	 * Places the wall plane and clears the grid.
+	 * @param WallPoint - A point on the wall
+	 * @param WallNormal - The wall normal, pointing towards the character
+	 */
+	void Anchor(const FVector& WallPoint, const FVector& WallNormal);
+
+	/** Forgets the wall, Update does nothing until Anchor is called again */
+	void Reset();
+
+	/**
+	 * Centers the grid on the character, tracing only cells that are new.
+	 * @param World - World to trace in
+	 * @param Location - Character location
+	 * @param Params - Query params, usually ignoring the character
+	 */
+	void Update(const UWorld* World, const FVector& Location, const FCollisionQueryParams& Params);
+
+	/**
+	 * Gets a cell relative to the character.
+	 * @param U - Cells to the right, negative for left
+	 * @param V - Cells up, negative for down
+	 */
+	const FCell& GetCell(int32 U, int32 V) const;
+
+	bool IsAnchored() const { return bAnchored; }
+
+	const FVector& GetNormal() const { return Normal; }
+	const FVector& GetRight() const { return Right; }
+	const FVector& GetUp() const { return Up; }
+
+	/** Total number of probe traces since the game started */
+	uint64 GetNumTraces() const { return NumTraces; }
+
+private:
+	FIntPoint ToCell(const FVector& Location) const;
+
+	/** Rebuilds the grid around NewCenter, reusing cells that are already traced */
+	void Shift(const UWorld* World, const FIntPoint& NewCenter, const FCollisionQueryParams& Params);
+
+	void TraceCell(const UWorld* World, FCell& Cell, const FCollisionQueryParams& Params);
+
+	FVector Origin{FVector::ZeroVector};
+	FVector Normal{FVector::ZeroVector};
+	FVector Right{FVector::ZeroVector};
+	FVector Up{FVector::ZeroVector};
+
+	FIntPoint Center{0, 0};
+	bool bAnchored = false;
+	bool bBuilt = false;
+
+	FCell Cells[GridSize * GridSize];
+
+	uint64 NumTraces = 0;
+};
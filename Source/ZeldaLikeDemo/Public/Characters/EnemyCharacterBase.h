@@ -0,0 +1,152 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Character.h"
+#include "GenericTeamAgentInterface.h"
+#include "EnemyCharacterBase.generated.h"
+
+/**
+ * How much an enemy knows about the player.
+ */
+UENUM(BlueprintType)
+enum class EEnemyAwareness : uint8
+{
+	EA_IDLE UMETA(DisplayName = "Idle"), // has not noticed the player
+	EA_SUSPICIOUS UMETA(DisplayName = "Suspicious"), // heard or glimpsed the player, investigates the last known location
+	EA_ALERTED UMETA(DisplayName = "Alerted"), // spotted the player, chases
+};
+
+/**
+ * Base enemy with sight and hearing.
+ * Perception does not tick per enemy, UEnemyPerceptionSubsystem schedules every enemy within a frame budget and
+ * calls ApplyPerception with the result, which also makes the enemy's decisions.
+ */
+UCLASS()
+class ZELDALIKEDEMO_API AEnemyCharacterBase : public ACharacter, public IGenericTeamAgentInterface
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this character's properties
+	AEnemyCharacterBase();
+
+	/** Distance the enemy sees the player at */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Perception")
+	float SightRadius = 2500.0f;
+
+	/** Half angle of the sight cone (in degrees) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Perception")
+	float SightHalfAngle = 60.0f;
+
+	/** Distance a noise of full loudness is heard at, such as sprinting */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Perception")
+	float HearingRadius = 1500.0f;
+
+	/** Awareness gained per second while the player is in sight at point blank, falls off with distance */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Perception")
+	float AwarenessGain = 2.0f;
+
+	/** Awareness lost per second without seeing or hearing the player */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Perception")
+	float AwarenessDecay = 0.2f;
+
+	/** Walk speed while idle */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Perception")
+	float IdleSpeed = 400.0f;
+
+	/** Walk speed while investigating a noise or a glimpse of the player */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Perception")
+	float SuspiciousSpeed = 250.0f;
+
+	/** Walk speed while chasing the player */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Perception")
+	float AlertedSpeed = 600.0f;
+
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = "Perception")
+	EEnemyAwareness Awareness{EEnemyAwareness::EA_IDLE};
+
+	/** 0 when idle, suspicious from 0.3, alerted at 1 */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = "Perception")
+	float AwarenessLevel = 0.0f;
+
+	/** Where the player was last seen or heard */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = "Perception")
+	FVector LastKnownLocation{FVector::ZeroVector};
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat")
+	float MaxHealth = 30.0f;
+
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = "Combat")
+	float Health = 0.0f;
+
+	/** Montage played when alerted and the player is within AttackRange, its Melee Window notify states hit */
+	UPROPERTY(EditDefaultsOnly, Category = "Combat")
+	TObjectPtr<UAnimMontage> AttackMontage;
+
+	/** Distance to the player at which the enemy attacks */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat")
+	float AttackRange = 180.0f;
+
+	/** Enemies of the same team do not hurt each other with melee hits */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat")
+	uint8 TeamId = 1;
+
+	//~ Begin IGenericTeamAgentInterface Interface
+	virtual FGenericTeamId GetGenericTeamId() const override { return FGenericTeamId(TeamId); }
+	//~ End IGenericTeamAgentInterface Interface
+
+	/** Seconds the corpse stays before it is removed */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat")
+	float CorpseLifeSpan = 5.0f;
+
+	/**
+	 * Takes damage from melee hits and explosions.
+	 * Being hit alerts the enemy to the attacker, at no health it dies.
+	 */
+	virtual float TakeDamage(float DamageAmount, const FDamageEvent& DamageEvent, AController* EventInstigator,
+	                         AActor* DamageCauser) override;
+
+	/**
+	 * Checks whether a location is inside the sight cone and range, without line of sight.
+	 * @param Location - World location to test
+	 */
+	bool IsInSightCone(const FVector& Location) const;
+
+	/**
+	 * Applies one perception update and decides what to do next.
+	 * @param bSeen - True if the player was in the sight cone with line of sight
+	 * @param bHeard - True if the player's noise reached the enemy
+	 * @param PlayerLocation - Player location at the update
+	 * @param DeltaTime - Time since the previous update of this enemy
+	 */
+	void ApplyPerception(bool bSeen, bool bHeard, const FVector& PlayerLocation, float DeltaTime);
+
+protected:
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Called when the awareness state changes, e.g. to play a reaction */
+	UFUNCTION(BlueprintImplementableEvent, Category = "Perception")
+	void OnAwarenessChanged(EEnemyAwareness OldAwareness, EEnemyAwareness NewAwareness);
+
+	/** Called when health reaches zero, e.g. to play a death animation */
+	UFUNCTION(BlueprintImplementableEvent, Category = "Combat")
+	void OnDeath(AActor* Killer);
+
+private:
+	/**
+	 * Moves towards the last known location when suspicious or alerted, stops when idle.
+	 * Attacks when alerted and the player is in range.
+	 */
+	void Decide();
+
+	/** Stops perception, movement and collision, then removes the enemy after CorpseLifeSpan */
+	void Die(AActor* Killer);
+
+	/** Location of the last move request, avoids repathing for small changes */
+	FVector MoveTarget{FVector::ZeroVector};
+};
@@ -7,11 +7,17 @@
 #include "GameFramework/Character.h"
 #include "Camera/CameraComponent.h"
 #include "GameFramework/SpringArmComponent.h"
+#include "Characters/ClimbingSurfaceCache.h"
 #include "MyCharacterBase.generated.h"
 
 class UInputAction;
-class UInputMappingContext;
 class UMyLayout;
+class UPlayerBootstrapData;
+class UTrajectoryPredictionComponent;
+class UInputLatencyComponent;
+class UStreamingLookAheadComponent;
+class UWindAudioComponent;
+class UTelemetrySubsystem;
 
 /**
  * Enumeration defining different movement types for the character.
@@ -26,6 +32,8 @@ enum class EMovementTypes : uint8
 	MM_SPRINTING UMETA(DisplayName = "Sprinting"), // sprinting
 	MM_GLIDING UMETA(DisplayName = "GLiding"), // gliding
 	MM_FALLING UMETA(DisplayName = "Falling"), // falling cannot run and sprint
+	MM_CLIMBING UMETA(DisplayName = "Climbing"), // climbing a wall, drains stamina while moving
+	MM_SWIMMING UMETA(DisplayName = "Swimming"), // swimming at the water surface, sprinting drains stamina
 };
 
 UENUM(BlueprintType)
@@ -49,6 +57,9 @@ class ZELDALIKEDEMO_API AMyCharacterBase : public ACharacter
 {
 	GENERATED_BODY()
 
+	/** Calls the protected input and stamina handlers directly */
+	friend class UHotPathBenchmarkCommandlet;
+
 public:
 	/**
 	 * Constructor for AMyCharacterBase.
@@ -64,12 +75,37 @@ public:
 	UPROPERTY(EditAnywhere, Category="Comps")
 	TObjectPtr<UCameraComponent> FollowCamera;
 
-	UPROPERTY(EditAnywhere, Category="Comps")
+	/** Glider shown while gliding, borrowed from UGliderPoolSubsystem and null while not needed */
+	UPROPERTY(Transient, VisibleInstanceOnly, Category="Comps")
 	TObjectPtr<USkeletalMeshComponent> Parachute;
 
-	/** Input mapping context for the character's input actions */
-	UPROPERTY(EditAnywhere, Category="Inputs")
-	TObjectPtr<UInputMappingContext> MappingContext;
+	/** Socket of the character mesh the glider is attached to */
+	UPROPERTY(EditDefaultsOnly, Category="Comps")
+	FName ParachuteSocket;
+
+	/** Glider transform relative to ParachuteSocket */
+	UPROPERTY(EditDefaultsOnly, Category="Comps")
+	FTransform ParachuteRelativeTransform;
+
+	/** How long the glider is kept after landing before it returns to the pool (in seconds) */
+	UPROPERTY(EditDefaultsOnly, Category="Comps")
+	float ParachuteReleaseDelay = 3.0f;
+
+	/** Predicts the throw arc while aiming and the landing point while gliding */
+	UPROPERTY(VisibleAnywhere, Category="Comps")
+	TObjectPtr<UTrajectoryPredictionComponent> TrajectoryPredictor;
+
+	/** Measures how long inputs take to reach movement and animation */
+	UPROPERTY(VisibleAnywhere, Category="Comps")
+	TObjectPtr<UInputLatencyComponent> InputLatency;
+
+	/** Streams World Partition cells in ahead of the player while sprinting or gliding */
+	UPROPERTY(VisibleAnywhere, Category="Comps")
+	TObjectPtr<UStreamingLookAheadComponent> StreamingLookAhead;
+
+	/** Synthesizes glide wind, wind tunnel lift and breathing for the local player */
+	UPROPERTY(VisibleAnywhere, Category="Comps")
+	TObjectPtr<UWindAudioComponent> WindAudio;
 
 	/** Input action for character movement */
 	UPROPERTY(EditAnywhere, Category="Inputs")
@@ -86,6 +122,10 @@ public:
 	UPROPERTY(EditAnywhere, Category="Inputs")
 	TObjectPtr<UInputAction> JumpGlideAction;
 
+	/** Input action for melee attacks */
+	UPROPERTY(EditAnywhere, Category="Inputs")
+	TObjectPtr<UInputAction> AttackAction;
+
 	/** Current movement type/state of the character */
 	UPROPERTY(EditAnywhere, Category="Movement")
 	EMovementTypes CurrentMT{EMovementTypes::MM_MAX};
@@ -93,12 +133,64 @@ public:
 	UPROPERTY(EditDefaultsOnly, Category = "Movement")
 	FVector EnableGlideDistance{0.0f, 0.0f, 150.0f};
 
+	/** Vertical speed the character sinks at while gliding */
+	UPROPERTY(EditDefaultsOnly, Category = "Movement")
+	float GlideSinkSpeed = 100.0f;
+
+	/** Movement speed on a wall */
+	UPROPERTY(EditDefaultsOnly, Category = "Movement|Climbing")
+	float ClimbSpeed = 150.0f;
+
+	/** Gap kept between the capsule and the wall while climbing */
+	UPROPERTY(EditDefaultsOnly, Category = "Movement|Climbing")
+	float ClimbWallGap = 5.0f;
+
+	/** Speed the character is pushed off the wall when jumping away */
+	UPROPERTY(EditDefaultsOnly, Category = "Movement|Climbing")
+	float ClimbJumpOffSpeed = 300.0f;
+
+	/** Movement speed in water */
+	UPROPERTY(EditDefaultsOnly, Category = "Movement|Swimming")
+	float SwimSpeed = 300.0f;
+
+	/** Movement speed in water while sprinting */
+	UPROPERTY(EditDefaultsOnly, Category = "Movement|Swimming")
+	float SwimSprintSpeed = 600.0f;
+
+	/** Depth of the capsule center below the surface while swimming */
+	UPROPERTY(EditDefaultsOnly, Category = "Movement|Swimming")
+	float SwimFloatDepth = 60.0f;
+
+	/** Depth an exhausted swimmer sinks to before being put back on dry ground, less in shallow water */
+	UPROPERTY(EditDefaultsOnly, Category = "Movement|Swimming")
+	float DrownDepth = 300.0f;
+
+	/** Buoyancy while swimming, exhausted swimmers have none and sink */
+	UPROPERTY(EditDefaultsOnly, Category = "Movement|Swimming")
+	float SwimBuoyancy = 1.0f;
+
+	/** True while sprinting in water */
+	bool bSwimSprinting = false;
+
+	/** Where the character last stood on the ground, exhausted swimmers are put back here */
+	FVector LastDryLocation{FVector::ZeroVector};
+
+	/** Probe grid around the character while climbing */
+	FClimbingSurfaceCache ClimbSurface;
+
+	/** Frames spent climbing, compared against ClimbSurface's trace count when play ends */
+	uint64 NumClimbFrames = 0;
+
 	UPROPERTY()
 	EMovementTypes PreviousMT;
 
-	/** Class reference for the UI layout widget */
-	UPROPERTY(EditDefaultsOnly, Category = "UI")
-	TSubclassOf<UUserWidget> LayoutClassRef;
+	/** Mapping context, layout widget class, glider mesh and rune assets, streamed in by UPlayerBootstrapSubsystem */
+	UPROPERTY(Transient, VisibleInstanceOnly, Category = "UI")
+	TObjectPtr<const UPlayerBootstrapData> BootstrapData;
+
+	/** Session telemetry, null when recording is off */
+	UPROPERTY(Transient)
+	TObjectPtr<UTelemetrySubsystem> Telemetry;
 
 	/** Instance of the UI layout widget */
 	UPROPERTY(EditDefaultsOnly, Category = "UI")
@@ -116,15 +208,71 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Runes")
 	ERunes ActiveRune{ERunes::R_EMAX};
 
+	/** Montage played by the attack input, its Melee Window notify states deal the damage */
+	UPROPERTY(EditDefaultsOnly, Category = "Combat")
+	TObjectPtr<UAnimMontage> AttackMontage;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat")
+	float MaxHealth = 100.0f;
+
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = "Combat")
+	float CurrentHealth = 0.0f;
+
+	/** True while the attack montage plays */
+	bool IsAttacking() const;
+
+	/**
+	 * Takes damage from melee hits and explosions.
+	 * A defeated player is put back on dry ground with full health, like a drowned one.
+	 */
+	virtual float TakeDamage(float DamageAmount, const FDamageEvent& DamageEvent, AController* EventInstigator,
+	                         AActor* DamageCauser) override;
+
+	/**
+	 * Gets how loud the character's movement is for enemies listening for it.
+	 * @return 1 for sprinting, less for quieter movement, 0 when standing still
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure)
+	float GetNoiseLoudness() const;
+
+	/**
+	 * Spawns the actor of the active rune, e.g. a bomb or an ice pillar.
+	 * @return The spawned actor, null if no rune is active or the bootstrap data has no class for it
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runes")
+	AActor* SpawnRuneActor(const FTransform& Transform);
+
 protected:
 	/**
 	 * Called when the game starts or when spawned.
-	 * Initializes input subsystems, stamina, and UI elements.
+	 * Waits for the bootstrap assets, see OnBootstrapLoaded.
 	 */
 	virtual void BeginPlay() override;
 
+	/**
+	 * Called once the PlayerBootstrap bundle is resident.
+	 * Initializes input subsystems, stamina, and UI elements.
+	 * @param Data - The loaded bootstrap assets, null if none are registered
+	 */
+	void OnBootstrapLoaded(const UPlayerBootstrapData* Data);
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	virtual void Landed(const FHitResult& Hit) override;
 
+	/**
+	 * Called by the movement component when a move is blocked.
+	 * Starts climbing on walls and ends it on floors, so no probes run while the character is not touching anything.
+	 * @param Impact - The blocking hit
+	 */
+	virtual void MoveBlockedBy(const FHitResult& Impact) override;
+
+	/**
+	 * Follows the movement component in and out of water.
+	 * Water volumes switch it to swimming from any mode, including gliding and climbing.
+	 */
+	virtual void OnMovementModeChanged(EMovementMode PrevMovementMode, uint8 PreviousCustomMode = 0) override;
+
 #pragma region Inputs Node
 	/**
 	 * Handles continuous movement input.
@@ -183,6 +331,16 @@ protected:
 	UFUNCTION()
 	void JumpGlide_Completed(const FInputActionValue& val);
 #pragma endregion Jump & Glide
+
+#pragma region Combat
+	/**
+	 * Handles attack input.
+	 * Plays the attack montage when standing or running on the ground.
+	 * @param val - The input action value
+	 */
+	UFUNCTION()
+	void Attack_Started(const FInputActionValue& val);
+#pragma endregion Combat
 	
 public:
 	/**
@@ -228,6 +386,74 @@ public:
 
 	void SetFalling();
 
+	/**
+	 * Configures character for climbing.
+	 * Disables gravity, aligns to the wall and begins stamina depletion.
+	 */
+	void SetClimbing();
+
+	/**
+	 * Restores ground rotation settings after climbing.
+	 */
+	void EndClimbing();
+
+	/**
+	 * Switches to climbing if the character is pushing into a climbable wall.
+	 * @param Wall - The blocking hit against the wall
+	 */
+	void TryStartClimbing(const FHitResult& Wall);
+
+	/**
+	 * Keeps the climbing character attached to the wall, called every tick while climbing.
+	 * Handles letting go when the surface ends and pulling up over ledges.
+	 */
+	void UpdateClimbing();
+
+	/**
+	 * Configures character for swimming.
+	 * Normal swimming neither drains nor recovers stamina.
+	 */
+	void SetSwimming();
+
+	/**
+	 * Starts or stops sprinting in water, sprinting drains stamina.
+	 * @param bSprint - True to sprint
+	 */
+	void SetSwimSprint(bool bSprint);
+
+	/**
+	 * Holds the swimmer at the surface and carries it along the flow, called every tick while swimming.
+	 * Exhausted swimmers sink instead and are put back on dry ground past DrownDepth or at the bottom of the water.
+	 * @param DeltaTime - Frame time
+	 */
+	void UpdateSwimming(float DeltaTime);
+
+	/**
+	 * Lifts the glider over burning ground, called every tick while gliding.
+	 * Applied like the lift of a wind tunnel, see UFireGridSubsystem::SampleUpdraft.
+	 * @param DeltaTime - Frame time
+	 */
+	void RideThermals(float DeltaTime);
+
+	/** Timer handle for returning the glider to the pool */
+	FTimerHandle ReleaseParachuteTimerHandle;
+
+	/**
+	 * Borrows the glider if needed and shows it.
+	 * Cancels a pending release so quick re-glides reuse the same component.
+	 */
+	void ShowParachute();
+
+	/**
+	 * Hides the glider and schedules its release.
+	 */
+	void HideParachute();
+
+	/**
+	 * Returns the glider to the pool.
+	 */
+	void ReleaseParachute();
+
 
 #pragma region Stamina
 	/** Current stamina value */
@@ -246,6 +472,10 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Stamina")
 	float StaminaDepletionAmount = 0.5f;
 
+	/** Amount of stamina depleted per update while moving on a wall */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Stamina")
+	float ClimbStaminaDepletionAmount = 0.3f;
+
 	/** Timer handle for stamina depletion */
 	FTimerHandle DrainStaminaTimerHandle;
 
@@ -291,8 +521,7 @@ public:
 	 */
 	void ClearDrainRecoverStaminaTimer();
 
-	FTimerHandle AddGravityForFlyingTimerHandle;
-
+	/** Keeps the glider sinking at GlideSinkSpeed, called every tick while gliding */
 	void AddGravityForFlying();
 
 #pragma endregion Stamina
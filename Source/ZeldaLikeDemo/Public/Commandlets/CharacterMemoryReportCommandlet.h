@@ -0,0 +1,27 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "CharacterMemoryReportCommandlet.generated.h"
+
+/**
+ * Reports the memory used by one spawned AMyCharacterBase and each of its components.
+ *
+ * Usage: UnrealEditor-Cmd ZeldaLikeDemo.uproject -run=CharacterMemoryReport [-Class=/Game/Path/BP_Player.BP_Player_C]
+ *        [-Count=50] [-CSV=Saved/CharacterMemory.csv] [-Budget=65536]
+ *
+ * -Count spawns that many characters and reports the average growth of used physical memory per character.
+ * -Budget makes the commandlet fail when the measured size of one character exceeds the given bytes.
+ */
+UCLASS()
+class ZELDALIKEDEMO_API UCharacterMemoryReportCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UCharacterMemoryReportCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,73 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "HotPathBenchmarkCommandlet.generated.h"
+
+/**
+ * Time and allocation budget of one benchmark.
+ */
+USTRUCT()
+struct FHotPathBudget
+{
+	GENERATED_BODY()
+
+	/** Benchmark the budget applies to */
+	UPROPERTY(Config)
+	FName Name;
+
+	/** Average time per call, 0 leaves time unchecked */
+	UPROPERTY(Config)
+	double MaxNanoseconds = 0.0;
+
+	/** Average heap allocations per call, negative leaves allocations unchecked */
+	UPROPERTY(Config)
+	double MaxAllocations = 0.0;
+
+	/** Average scene query traces per call for rows that count them, negative leaves traces unchecked */
+	UPROPERTY(Config)
+	double MaxTraces = -1.0;
+};
+
+/**
+ * Times the gameplay hot paths of this module on warmed-up objects and fails when one exceeds its budget.
+ * Budgets are committed in DefaultGame.ini so a regression shows up when the benchmark is run for review.
+ * The same benchmarks run as automation tests, one per row, which is how CI runs them:
+ *
+ *   UnrealEditor-Cmd ZeldaLikeDemo.uproject -nullrhi -unattended
+ *       -ExecCmds="Automation RunTests ZeldaLikeDemo.Perf;Quit"
+ *
+ * The commandlet adds a table and a CSV of all rows on top:
+ *
+ * Usage: UnrealEditor-Cmd ZeldaLikeDemo.uproject -run=HotPathBenchmark [-Iterations=1000000]
+ *        [-Bench=LocomotionManager] [-CSV=Saved/HotPathBenchmark.csv]
+ *
+ * Allocations are counted on the benchmark thread only, by wrapping GMalloc once for the rest of the process.
+ * Rows that step the physics scene cap their own iteration count, a million world ticks would take hours.
+ * The benchmark world never begins play, HotPathBenchmark::Run lists what each row sets up itself or skips because
+ * of it.
+ */
+UCLASS(Config = Game)
+class ZELDALIKEDEMO_API UHotPathBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UHotPathBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+	/** Budgets by benchmark name, a benchmark without one only reports */
+	UPROPERTY(Config)
+	TArray<FHotPathBudget> Budgets;
+
+	/** Calls made before timing starts */
+	UPROPERTY(Config)
+	int32 WarmupIterations = 10000;
+
+	/** Timed calls per benchmark, -Iterations overrides it for the commandlet */
+	UPROPERTY(Config)
+	int64 Iterations = 1000000;
+};
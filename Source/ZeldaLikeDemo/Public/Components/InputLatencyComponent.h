@@ -0,0 +1,97 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Debug/LatencyHistogram.h"
+#include "Engine/EngineTypes.h"
+#include "InputLatencyComponent.generated.h"
+
+class AMyCharacterBase;
+
+/**
+ * Inputs whose latency is tracked.
+ */
+UENUM(BlueprintType)
+enum class ELatencyInputs : uint8
+{
+	LI_MOVE UMETA(DisplayName = "Move"), // first Move_Triggered after the stick was released
+	LI_SPRINT UMETA(DisplayName = "Sprint"), // Sprint_Started
+	LI_JUMPGLIDE UMETA(DisplayName = "JumpGlide"), // JumpGlide_Started
+	LI_MAX UMETA(Hidden),
+};
+
+/**
+ * Measures input-to-motion latency of the owning character.
+ * Each tagged input keeps its timestamp until the movement component applies the change, then until
+ * UMyAnimInst sees the new state. Results go to stats, to the CSV profiler and to per-stage histograms that are
+ * written to the profiling folder when play ends. Synthetic input, e.g. injected through
+ * UEnhancedInputLocalPlayerSubsystem::InjectInputForAction in a headless run, reaches the same handlers and is
+ * measured the same way.
+ */
+UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
+class ZELDALIKEDEMO_API UInputLatencyComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UInputLatencyComponent();
+
+	/** Inputs still waiting after this many frames are dropped, e.g. sprinting while standing still */
+	UPROPERTY(EditAnywhere, Category = "Latency")
+	int32 MaxTrackedFrames = 120;
+
+	/**
+	 * Starts tracking an input event, called from the input handlers.
+	 * @param Input - The input that was received
+	 */
+	void TagInput(ELatencyInputs Input);
+
+	/**
+	 * Completes the animation stage of tracked inputs, called from UMyAnimInst::NativeUpdateAnimation.
+	 */
+	void ObserveAnimation(float GroundSpeed, bool bShouldMove, bool bIsFalling, bool bIsGliding);
+
+	/** Logs the histograms and writes them as CSV to the profiling folder */
+	void DumpHistograms() const;
+
+protected:
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType,
+	                           FActorComponentTickFunction* ThisTickFunction) override;
+
+private:
+	/** State captured when an input is tagged, compared against later frames to detect the change */
+	struct FTrackedInput
+	{
+		uint64 InputCycles = 0;
+		uint64 InputFrame = 0;
+		uint64 MotionCycles = 0;
+		uint64 MotionFrame = 0;
+		float PreviousMaxSpeed = 0.0f;
+		TEnumAsByte<EMovementMode> PreviousMode = MOVE_None;
+		bool bWasFalling = false;
+		bool bWasGliding = false;
+		bool bWaitingMotion = false;
+		bool bWaitingAnimation = false;
+	};
+
+	/** Records a finished stage into its histogram, stat and CSV column */
+	void RecordStage(ELatencyInputs Input, bool bAnimationStage, uint64 StartCycles, uint64 StartFrame);
+
+	UPROPERTY()
+	TObjectPtr<AMyCharacterBase> OwnerCharacter;
+
+	FTrackedInput Tracked[static_cast<int32>(ELatencyInputs::LI_MAX)];
+
+	/** Input to movement histograms, one per input */
+	Debug::FLatencyHistogram MotionHistograms[static_cast<int32>(ELatencyInputs::LI_MAX)];
+
+	/** Input to animation histograms, one per input */
+	Debug::FLatencyHistogram AnimationHistograms[static_cast<int32>(ELatencyInputs::LI_MAX)];
+};
@@ -0,0 +1,61 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "WorldPartition/WorldPartitionStreamingSource.h"
+#include "StreamingLookAheadComponent.generated.h"
+
+/**
+ * World Partition streaming source placed ahead of a fast-moving owner.
+ * The player controller streams around the player, this adds a source where the owner will be in LookAheadSeconds
+ * while sprinting or gliding, so cells are loaded before the player reaches them.
+ */
+UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
+class ZELDALIKEDEMO_API UStreamingLookAheadComponent : public UActorComponent,
+                                                       public IWorldPartitionStreamingSourceProvider
+{
+	GENERATED_BODY()
+
+public:
+	UStreamingLookAheadComponent();
+
+	/** How far ahead in time the source is placed (in seconds) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Streaming")
+	float LookAheadSeconds = 2.5f;
+
+	/** Below this speed the player controller's own source is enough (in cm/s) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Streaming")
+	float MinSpeed = 600.0f;
+
+	/** Upper bound of the look-ahead distance */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Streaming")
+	float MaxDistance = 12800.0f;
+
+	/** Scale of the grid loading range at the look-ahead location */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Streaming")
+	float LoadingRangeScale = 0.5f;
+
+	/**
+	 * Looks ahead along a velocity instead of the owner's, for owners that are teleported rather than moved.
+	 * @param Velocity - Velocity to look ahead along, zero goes back to the owner's
+	 */
+	void SetVelocityOverride(const FVector& Velocity) { VelocityOverride = Velocity; }
+
+	//~ Begin IWorldPartitionStreamingSourceProvider Interface
+	virtual bool GetStreamingSources(TArray<FWorldPartitionStreamingSource>& OutStreamingSources) const override;
+	virtual const UObject* GetStreamingSourceOwner() const override { return this; }
+	//~ End IWorldPartitionStreamingSourceProvider Interface
+
+protected:
+	virtual void OnRegister() override;
+
+	virtual void OnUnregister() override;
+
+private:
+	FName SourceName;
+
+	/** Used instead of the owner's velocity when not zero */
+	FVector VelocityOverride{FVector::ZeroVector};
+};
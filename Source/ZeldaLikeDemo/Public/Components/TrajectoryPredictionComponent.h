@@ -0,0 +1,179 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "TrajectoryPredictionComponent.generated.h"
+
+class AMyCharacterBase;
+class UDecalComponent;
+class UInstancedStaticMeshComponent;
+class UMaterialInterface;
+class UStaticMesh;
+
+/**
+ * Which path the predictor is currently tracing.
+ */
+UENUM(BlueprintType)
+enum class ETrajectoryModes : uint8
+{
+	TM_NONE UMETA(DisplayName = "None"), // nothing to predict
+	TM_THROW UMETA(DisplayName = "Throw"), // projectile arc while aiming a throw
+	TM_GLIDE UMETA(DisplayName = "Glide"), // glide descent including wind lift
+};
+
+/**
+ * Predicts the throw arc and the glide landing point of the owning character.
+ * Samples are integrated four steps at a time with SIMD math and checked against the world with one coarse
+ * sweep per batch. A prediction is rebuilt only when its inputs drift beyond a tolerance, and the sweeps are
+ * spread over several frames so the work never exceeds a fixed time budget. A prediction is swept to the end and
+ * shown before drifted inputs replace it, so steering never keeps the display from updating.
+ */
+UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
+class ZELDALIKEDEMO_API UTrajectoryPredictionComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UTrajectoryPredictionComponent();
+
+	/** Time between two integrated samples (in seconds) */
+	UPROPERTY(EditAnywhere, Category = "Prediction")
+	float StepTime = 0.05f;
+
+	/** Maximum number of samples per prediction, rounded up to a whole batch */
+	UPROPERTY(EditAnywhere, Category = "Prediction")
+	int32 MaxSamples = 128;
+
+	/** Time budget for collision sweeps each frame (in microseconds) */
+	UPROPERTY(EditAnywhere, Category = "Prediction")
+	float SweepBudgetMicroseconds = 50.0f;
+
+	/** How far the character may drift from the predicted path before the prediction is rebuilt */
+	UPROPERTY(EditAnywhere, Category = "Prediction")
+	float PositionTolerance = 25.0f;
+
+	/** How much the launch velocity may change before the prediction is rebuilt, at low speeds */
+	UPROPERTY(EditAnywhere, Category = "Prediction")
+	float VelocityTolerance = 20.0f;
+
+	/**
+	 * How much the launch velocity may change before the prediction is rebuilt, as a fraction of the launch speed.
+	 * 0.1 allows about 6 degrees of steering, so a turning glider is not rebuilt every frame.
+	 */
+	UPROPERTY(EditAnywhere, Category = "Prediction", meta = (ClampMin = "0.0"))
+	float RelativeVelocityTolerance = 0.1f;
+
+	/** Launch speed of a thrown object */
+	UPROPERTY(EditAnywhere, Category = "Prediction|Throw")
+	float ThrowSpeed = 1200.0f;
+
+	/** Extra pitch added to the camera direction when throwing */
+	UPROPERTY(EditAnywhere, Category = "Prediction|Throw")
+	float ThrowPitchBias = 15.0f;
+
+	/** Offset from the character location where a throw starts */
+	UPROPERTY(EditAnywhere, Category = "Prediction|Throw")
+	FVector ThrowOriginOffset{0.0f, 0.0f, 60.0f};
+
+	/** Radius of the sphere swept along a throw arc */
+	UPROPERTY(EditAnywhere, Category = "Prediction|Throw")
+	float ProjectileRadius = 10.0f;
+
+	/** Mesh instanced along the predicted arc, left empty to hide the arc */
+	UPROPERTY(EditAnywhere, Category = "Prediction|Display")
+	TObjectPtr<UStaticMesh> ArcMarkerMesh;
+
+	/** Place one arc marker every N samples */
+	UPROPERTY(EditAnywhere, Category = "Prediction|Display")
+	int32 ArcMarkerStride = 2;
+
+	/** Decal projected at the predicted impact point, left empty to hide the marker */
+	UPROPERTY(EditAnywhere, Category = "Prediction|Display")
+	TObjectPtr<UMaterialInterface> LandingDecalMaterial;
+
+	UPROPERTY(EditAnywhere, Category = "Prediction|Display")
+	FVector LandingDecalSize{32.0f, 64.0f, 64.0f};
+
+	/** Current prediction mode */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Prediction")
+	ETrajectoryModes Mode{ETrajectoryModes::TM_NONE};
+
+	/** True once the whole path is swept and either hit something or ran out of samples */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Prediction")
+	bool bPredictionComplete = false;
+
+	/** True if the swept path hit something */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Prediction")
+	bool bHasImpact = false;
+
+	/** Predicted impact or landing point */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Prediction")
+	FVector ImpactLocation{FVector::ZeroVector};
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Prediction")
+	FVector ImpactNormal{FVector::UpVector};
+
+protected:
+	virtual void BeginPlay() override;
+
+public:
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType,
+	                           FActorComponentTickFunction* ThisTickFunction) override;
+
+private:
+	/** Picks the mode from the owner's locomotion and aiming state */
+	ETrajectoryModes ResolveMode() const;
+
+	/** Computes where the path starts and its launch velocity for the given mode */
+	void GatherInputs(ETrajectoryModes InMode, FVector& OutOrigin, FVector& OutVelocity) const;
+
+	/** Returns true if the inputs drifted far enough from the last prediction to rebuild it */
+	bool NeedsRebuild(const FVector& Origin, const FVector& Velocity) const;
+
+	/** Integrates all samples of a new prediction and restarts the sweeps */
+	void Integrate(const FVector& Origin, const FVector& Velocity);
+
+	/**
+	 * Continues sweeping the path batch by batch until it is finished or the budget is spent.
+	 * @param StartCycles - Cycle counter value at the start of this frame's prediction work
+	 */
+	void ContinueSweeps(uint64 StartCycles);
+
+	/** Returns a sample as a world location */
+	FVector GetSample(int32 Index) const;
+
+	/** Pushes the finished prediction to the arc and decal components */
+	void UpdateDisplay();
+
+	void ShowDisplay(bool bShow);
+
+	UPROPERTY()
+	TObjectPtr<AMyCharacterBase> OwnerCharacter;
+
+	UPROPERTY()
+	TObjectPtr<UInstancedStaticMeshComponent> ArcMarkers;
+
+	UPROPERTY()
+	TObjectPtr<UDecalComponent> LandingDecal;
+
+	/** Samples stored as structure of arrays relative to PredictionOrigin, so a batch is one vector store per axis */
+	TArray<float> SampleX;
+	TArray<float> SampleY;
+	TArray<float> SampleZ;
+
+	/** Number of valid samples, trimmed to the impact once it is found */
+	int32 NumSamples = 0;
+
+	/** Next batch to sweep */
+	int32 SweepCursor = 0;
+
+	FVector PredictionOrigin{FVector::ZeroVector};
+	FVector PredictionVelocity{FVector::ZeroVector};
+	float PredictionWorldTime = 0.0f;
+	uint32 PredictionWindVersion = 0;
+
+	/** Reused between updates to avoid allocating when the arc is redrawn */
+	TArray<FTransform> ArcTransforms;
+};
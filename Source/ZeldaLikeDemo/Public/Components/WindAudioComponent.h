@@ -0,0 +1,76 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <atomic>
+
+#include "CoreMinimal.h"
+#include "Audio/WindSynth.h"
+#include "Components/SynthComponent.h"
+#include "WindAudioComponent.generated.h"
+
+class AMyCharacterBase;
+
+/**
+ * Procedural glide wind, wind tunnel lift and breathing of the owning character.
+ * The sound is synthesized by FWindSynth on the audio render thread. Gameplay only stores three normalized
+ * parameters per frame, so no looping wave assets are streamed. Only the locally controlled player plays the
+ * synth, which keeps the audio cost constant however many characters glide.
+ */
+UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
+class ZELDALIKEDEMO_API UWindAudioComponent : public USynthComponent
+{
+	GENERATED_BODY()
+
+public:
+	UWindAudioComponent();
+
+	/** Airspeed at which the wind is loudest and brightest (in cm/s) */
+	UPROPERTY(EditAnywhere, Category = "Wind Audio")
+	float FullWindAirspeed = 1500.0f;
+
+	/** Wind tunnel lift at which the rumble is loudest (in cm/s) */
+	UPROPERTY(EditAnywhere, Category = "Wind Audio")
+	float FullLiftSpeed = 1200.0f;
+
+	/** Breathing effort when sprinting or climbing on full stamina, rising to 1 as stamina runs out */
+	UPROPERTY(EditAnywhere, Category = "Wind Audio", meta = (ClampMin = "0", ClampMax = "1"))
+	float ExertionBreath = 0.3f;
+
+	/** Breathing effort while recovering stamina, scaled by the missing stamina */
+	UPROPERTY(EditAnywhere, Category = "Wind Audio", meta = (ClampMin = "0", ClampMax = "1"))
+	float RecoveryBreath = 0.5f;
+
+	/** Parameters last sent to the synth, safe to call from any thread */
+	FWindSynth::FParams GetParams() const;
+
+protected:
+	virtual void BeginPlay() override;
+
+	/** Called by the audio mixer before the first block */
+	virtual bool Init(int32& SampleRate) override;
+
+	/** Called on the audio render thread for every block */
+	virtual int32 OnGenerateAudio(float* OutAudio, int32 NumSamples) override;
+
+public:
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType,
+	                           FActorComponentTickFunction* ThisTickFunction) override;
+
+private:
+	/** Computes the synth parameters from the owner's movement, wind and stamina */
+	FWindSynth::FParams ComputeParams() const;
+
+	UPROPERTY()
+	TObjectPtr<AMyCharacterBase> OwnerCharacter;
+
+	/** Only touched by the audio render thread after Init */
+	FWindSynth Synth;
+
+	/** Written by the game thread, read once per block by the audio render thread */
+	std::atomic<float> Airspeed{0.0f};
+	std::atomic<float> Lift{0.0f};
+	std::atomic<float> Breath{0.0f};
+
+	bool bSynthStarted = false;
+};
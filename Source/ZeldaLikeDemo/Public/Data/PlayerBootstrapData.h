@@ -0,0 +1,51 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Characters/MyCharacterBase.h"
+#include "Engine/DataAsset.h"
+#include "PlayerBootstrapData.generated.h"
+
+class UInputMappingContext;
+class UMyLayout;
+class USkeletalMesh;
+
+/**
+ * Assets the player character needs before it is playable.
+ * Every reference is soft and tagged with the PlayerBootstrap bundle, so UPlayerBootstrapSubsystem can stream
+ * them in during map load instead of loading them on the critical path with the character.
+ */
+UCLASS(BlueprintType)
+class ZELDALIKEDEMO_API UPlayerBootstrapData : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	/** Primary asset type registered in the asset manager settings */
+	static const FPrimaryAssetType PrimaryAssetType;
+
+	/** Bundle holding everything below */
+	static const FName BootstrapBundle;
+
+	/** Input mapping context added for the local player */
+	UPROPERTY(EditDefaultsOnly, Category = "Inputs", meta = (AssetBundles = "PlayerBootstrap"))
+	TSoftObjectPtr<UInputMappingContext> MappingContext;
+
+	/** Class of the UI layout widget */
+	UPROPERTY(EditDefaultsOnly, Category = "UI", meta = (AssetBundles = "PlayerBootstrap"))
+	TSoftClassPtr<UMyLayout> LayoutClass;
+
+	/** Mesh displayed by the glider */
+	UPROPERTY(EditDefaultsOnly, Category = "Comps", meta = (AssetBundles = "PlayerBootstrap"))
+	TSoftObjectPtr<USkeletalMesh> ParachuteMesh;
+
+	/**
+	 * Actor spawned by AMyCharacterBase::SpawnRuneActor for each rune.
+	 * Its navmesh geometry goes through URuneNavigationSubsystem::SpawnRuneActor.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Runes", meta = (AssetBundles = "PlayerBootstrap"))
+	TMap<ERunes, TSoftClassPtr<AActor>> RuneActorClasses;
+
+	virtual FPrimaryAssetId GetPrimaryAssetId() const override;
+};
@@ -0,0 +1,52 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+
+namespace Debug
+{
+	/**
+	 * Fixed bucket latency histogram in milliseconds.
+	 * Recording never allocates, so it can sit on gameplay hot paths.
+	 */
+	struct FLatencyHistogram
+	{
+		/** Upper bound of each bucket, the last bucket collects everything above */
+		static constexpr double BucketUpperMs[] = {4.0, 8.0, 16.7, 33.3, 50.0, 66.7, 100.0, 150.0, 250.0, 500.0};
+		static constexpr int32 NumBuckets = UE_ARRAY_COUNT(BucketUpperMs) + 1;
+
+		uint32 Counts[NumBuckets] = {};
+		uint32 NumSamples = 0;
+		double TotalMs = 0.0;
+		double MaxMs = 0.0;
+		uint64 TotalFrames = 0;
+
+		void Add(double Ms, uint64 Frames)
+		{
+			int32 Bucket = 0;
+			while (Bucket < NumBuckets - 1 && Ms > BucketUpperMs[Bucket])
+			{
+				++Bucket;
+			}
+			++Counts[Bucket];
+			++NumSamples;
+			TotalMs += Ms;
+			MaxMs = FMath::Max(MaxMs, Ms);
+			TotalFrames += Frames;
+		}
+
+		double GetAverageMs() const { return NumSamples > 0 ? TotalMs / NumSamples : 0.0; }
+
+		double GetAverageFrames() const { return NumSamples > 0 ? static_cast<double>(TotalFrames) / NumSamples : 0.0; }
+
+		/** Bucket label such as "16.7-33.3" */
+		static FString GetBucketLabel(int32 Bucket)
+		{
+			const double Lower = Bucket > 0 ? BucketUpperMs[Bucket - 1] : 0.0;
+			if (Bucket == NumBuckets - 1)
+			{
+				return FString::Printf(TEXT(">%.1f"), Lower);
+			}
+			return FString::Printf(TEXT("%.1f-%.1f"), Lower, BucketUpperMs[Bucket]);
+		}
+	};
+}
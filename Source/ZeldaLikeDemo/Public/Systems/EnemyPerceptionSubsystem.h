@@ -0,0 +1,87 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "EnemyPerceptionSubsystem.generated.h"
+
+class AEnemyCharacterBase;
+
+/**
+ * Time-sliced perception scheduler for all enemies.
+ * Each frame, enemies that are due are updated most overdue first until BudgetMicroseconds is spent. Enemies near
+ * the player are due more often than far ones. Line of sight traces of a frame are issued as one batch of async
+ * traces and applied when they complete next frame, so the game thread never waits on them.
+ */
+UCLASS(Config = Game)
+class ZELDALIKEDEMO_API UEnemyPerceptionSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+	/** Adds an enemy to the schedule, called from AEnemyCharacterBase::BeginPlay */
+	void RegisterEnemy(AEnemyCharacterBase* Enemy);
+
+	/** Removes an enemy from the schedule, called from AEnemyCharacterBase::EndPlay */
+	void UnregisterEnemy(AEnemyCharacterBase* Enemy);
+
+	/** Game thread time perception may use per frame */
+	UPROPERTY(Config)
+	float BudgetMicroseconds = 250.0f;
+
+	/** Line of sight traces issued per frame */
+	UPROPERTY(Config)
+	int32 MaxTracesPerFrame = 16;
+
+	/** Enemies this close to the player are updated every NearInterval */
+	UPROPERTY(Config)
+	float NearDistance = 1500.0f;
+
+	UPROPERTY(Config)
+	float NearInterval = 0.1f;
+
+	/** Enemies this far from the player or further are updated every FarInterval */
+	UPROPERTY(Config)
+	float FarDistance = 8000.0f;
+
+	UPROPERTY(Config)
+	float FarInterval = 1.0f;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	struct FAgent
+	{
+		TWeakObjectPtr<AEnemyCharacterBase> Enemy;
+
+		/** World time of the last applied update */
+		double LastUpdateTime = 0.0;
+
+		/** Line of sight trace in flight, invalid if none */
+		FTraceHandle PendingTrace;
+
+		/** Frame the pending trace was issued in */
+		uint64 TraceFrame = 0;
+
+		/** Hearing result of the update waiting for the trace */
+		bool bHeard = false;
+	};
+
+	/** Applies line of sight traces issued last frame, returns the number applied */
+	int32 ApplyCompletedTraces(const FVector& PlayerLocation, double Now);
+
+	/** Update interval of an enemy at a distance from the player */
+	float GetInterval(float Distance) const;
+
+	TArray<FAgent> Agents;
+
+	/** Due agents of this frame with how overdue they are, kept to avoid reallocating */
+	TArray<TPair<float, int32>> DueAgents;
+};
@@ -0,0 +1,91 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ExplosionFieldSubsystem.generated.h"
+
+class FChaosScene;
+class FExplosionFieldCallback;
+class UCurveFloat;
+
+/**
+ * Shape and strength of a single blast.
+ */
+USTRUCT(BlueprintType)
+struct FExplosionParams
+{
+	GENERATED_BODY()
+
+	/** Blast radius */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Explosion")
+	float Radius = 500.0f;
+
+	/** Impulse at the center of the blast, scaled by ImpulseCurve towards the edge */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Explosion")
+	float Impulse = 150000.0f;
+
+	/** Damage at the center of the blast, falls off linearly towards the edge */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Explosion")
+	float Damage = 20.0f;
+
+	/** Impulse scale over the normalized distance from the center, linear falloff when empty */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Explosion")
+	TObjectPtr<UCurveFloat> ImpulseCurve;
+};
+
+/**
+ * Applies blasts to the rigid bodies in range on the physics thread.
+ * A blast is handed to an async physics callback that pushes the bodies in the blast bounds before the next physics
+ * step, found through the solver's acceleration structure so bodies elsewhere in the level cost nothing. Only the
+ * pushed bodies in range come back to the game thread, where their actors are damaged after the step. Kinematic pawns
+ * are not in the solver's dynamic view, so they are damaged from a game thread overlap on pawns alone.
+ */
+UCLASS()
+class ZELDALIKEDEMO_API UExplosionFieldSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Damages pawns in range now and queues the impulses for the next physics step, the actors of the pushed bodies
+	 * are damaged once the step reports them.
+	 * @param Origin - Center of the blast
+	 * @param Params - Radius, impulse, damage and falloff
+	 * @param DamageCauser - Actor reported as the damage causer, usually the bomb
+	 * @param InstigatorController - Controller credited with the damage
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Explosion")
+	void Detonate(const FVector& Origin, const FExplosionParams& Params, AActor* DamageCauser = nullptr,
+	              AController* InstigatorController = nullptr);
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	virtual void Deinitialize() override;
+
+private:
+	/** Damage of a blast in flight on the physics thread */
+	struct FExplosionDamage
+	{
+		float Damage = 0.0f;
+		TWeakObjectPtr<AActor> DamageCauser;
+		TWeakObjectPtr<AController> InstigatorController;
+	};
+
+	/** Applies the damage of a blast once per pawn in range */
+	void ApplyPawnDamage(const FVector& Origin, const FExplosionParams& Params, AActor* DamageCauser,
+	                     AController* InstigatorController) const;
+
+	/** Damages the actors of the bodies the physics steps pushed */
+	void OnPhysScenePostTick(FChaosScene* Scene);
+
+	FExplosionFieldCallback* Callback = nullptr;
+
+	FDelegateHandle PostTickHandle;
+
+	/** Damage by blast id, until the physics step applying the blast reports back */
+	TMap<uint32, FExplosionDamage> PendingDamage;
+
+	uint32 LastBlastId = 0;
+};
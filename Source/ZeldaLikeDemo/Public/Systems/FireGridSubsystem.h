@@ -0,0 +1,223 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Chaos/ChaosEngineInterface.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FireGridSubsystem.generated.h"
+
+/**
+ * Grass and wood fire on a sparse grid over the terrain.
+ * The world is split into chunks of ChunkCells x ChunkCells cells, created on demand when fire reaches them. Each
+ * cell holds heat, fuel and whether it burns: burning cells heat their neighbours, cells with fuel ignite once hot
+ * enough, burn their fuel down and cool off once it is gone. Only chunks with heat in them are simulated, a few per
+ * frame in round robin, with vectorized kernels running on worker threads, so the cost follows the size of the fire
+ * rather than the size of the map. Burning cells push gliders up, see SampleUpdraft.
+ */
+UCLASS(Config = Game)
+class ZELDALIKEDEMO_API UFireGridSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Cells along the side of a chunk */
+	static constexpr int32 ChunkCells = 16;
+
+	/**
+	 * Heats every cell within a radius to ignition, e.g. for a bomb or a torch.
+	 * Cells without fuel do not catch fire. Cells of chunks that do not exist yet catch fire once their chunk was
+	 * created, within the MaxChunkCreationsPerFrame budget.
+	 * @param Location - Center of the fire
+	 * @param Radius - Radius of the ignited area
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Fire")
+	void Ignite(const FVector& Location, float Radius);
+
+	/**
+	 * Checks whether the cell under a location is burning.
+	 * @param Location - World location, only X and Y are used
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Fire")
+	bool IsBurning(const FVector& Location) const;
+
+	/**
+	 * Gets the thermal updraft at a location.
+	 * Rises with the share of burning cells around the location and fades out with the height above the ground.
+	 * @param Location - World location to sample
+	 * @return Lift velocity in cm/s
+	 */
+	FVector SampleUpdraft(const FVector& Location) const;
+
+	/** Number of cells burning at the last update of their chunk */
+	int32 GetNumBurningCells() const { return NumBurningCells; }
+
+	/** Incremented whenever cells catch fire or burn out, so cached updraft samples can be invalidated */
+	uint32 GetVersion() const { return Version; }
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+	/** Side of a cell (in cm) */
+	UPROPERTY(Config)
+	float CellSize = 200.0f;
+
+	/** Seconds between two updates of a burning chunk */
+	UPROPERTY(Config)
+	float StepSeconds = 0.1f;
+
+	/** Chunks updated per frame at most, chunks left over are updated in later frames */
+	UPROPERTY(Config)
+	int32 MaxChunksPerFrame = 32;
+
+	/** Chunks created per frame at most, each traces the ground under all of its cells */
+	UPROPERTY(Config)
+	int32 MaxChunkCreationsPerFrame = 1;
+
+	/** Heat at which a cell with fuel ignites, heat goes from 0 to 1 */
+	UPROPERTY(Config)
+	float IgnitionHeat = 0.6f;
+
+	/** Heat per second a cell gains from each burning neighbour */
+	UPROPERTY(Config)
+	float SpreadRate = 0.8f;
+
+	/** Heat per second every cell loses */
+	UPROPERTY(Config)
+	float CoolingRate = 0.25f;
+
+	/** Fuel per second a burning cell consumes, a full cell burns for 1 / BurnRate seconds */
+	UPROPERTY(Config)
+	float BurnRate = 0.12f;
+
+	/** Updraft above a fully burning area (in cm/s) */
+	UPROPERTY(Config)
+	float UpdraftSpeed = 700.0f;
+
+	/** Height above the ground the updraft fades out at (in cm) */
+	UPROPERTY(Config)
+	float UpdraftHeight = 4000.0f;
+
+	/** WorldStatic actors with this tag burn, e.g. grass meshes and wooden structures */
+	UPROPERTY(Config)
+	FName FlammableTag = TEXT("Flammable");
+
+	/** Physical surfaces that burn, e.g. grass painted on the landscape */
+	UPROPERTY(Config)
+	TArray<TEnumAsByte<EPhysicalSurface>> FlammableSurfaces;
+
+	/** Distance above and below the reference height the ground is searched for when a chunk is created */
+	UPROPERTY(Config)
+	float GroundSearchDistance = 5000.0f;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	static constexpr int32 NumChunkCells = ChunkCells * ChunkCells;
+
+	/** Edge flags of FChunk::BurningEdges, in the order of FChunk::Neighbors */
+	enum EChunkEdge : uint8
+	{
+		Edge_West = 1 << 0,
+		Edge_East = 1 << 1,
+		Edge_South = 1 << 2,
+		Edge_North = 1 << 3,
+	};
+
+	struct FChunk
+	{
+		FIntPoint Coord = FIntPoint::ZeroValue;
+
+		/** Cell data in rows of ChunkCells along X, laid out for 4-wide vector loads */
+		float Heat[NumChunkCells];
+		float Fuel[NumChunkCells];
+
+		/** 1 for burning cells, written only after all chunks of a batch were heated */
+		float Emission[NumChunkCells];
+
+		/** Ground height under each cell */
+		float GroundZ[NumChunkCells];
+
+		/** Chunk indices west, east, south and north, INDEX_NONE where none exists yet */
+		int32 Neighbors[4] = {INDEX_NONE, INDEX_NONE, INDEX_NONE, INDEX_NONE};
+
+		double LastUpdateTime = 0.0;
+
+		/** Time step of the update in flight */
+		float StepTime = 0.0f;
+
+		/** Highest heat after the last update, the chunk sleeps at 0 */
+		float MaxHeat = 0.0f;
+
+		int32 NumBurning = 0;
+
+		/** EChunkEdge flags of the edges with burning cells */
+		uint8 BurningEdges = 0;
+
+		/** EChunkEdge flags of the edges with fuel when the chunk was created, fire only spreads over those */
+		uint8 FuelEdges = 0;
+
+		/** Average ground height, where neighbours search for their ground */
+		float ReferenceZ = 0.0f;
+
+		bool bActive = false;
+	};
+
+	/** Heats and burns one chunk from its own and its neighbours' emission */
+	void UpdateHeat(FChunk& Chunk) const;
+
+	/** Recomputes emission, burning count and edge flags from the updated heat and fuel */
+	void UpdateEmission(FChunk& Chunk) const;
+
+	/** Creates a chunk and traces the ground and fuel of its cells, returns its index */
+	int32 CreateChunk(const FIntPoint& Coord, float ReferenceZ);
+
+	/**
+	 * Heats the cells within a radius to ignition and queues the chunks of the cells that do not exist yet.
+	 * @param OnlyChunk - Chunk whose cells are heated, or null for all existing chunks
+	 * @return Whether some cell within the radius is still waiting for its chunk
+	 */
+	bool IgniteCells(const FVector& Location, float Radius, const FIntPoint* OnlyChunk);
+
+	/** Queues a chunk to be created in a later frame, unless it is already queued */
+	void QueueChunk(const FIntPoint& Coord, float ReferenceZ);
+
+	/** Checks whether the ground hit under a cell burns */
+	bool IsFlammable(const FHitResult& Hit) const;
+
+	/** Wakes a sleeping chunk up */
+	void Activate(int32 ChunkIndex);
+
+	/** Spreads to the neighbours of a chunk with burning edges, creating missing ones later */
+	void WakeNeighbors(int32 ChunkIndex);
+
+	/** Gets the chunk and cell index of a cell coordinate, the chunk is null if it does not exist */
+	const FChunk* FindCell(const FIntPoint& Cell, int32& OutCellIndex) const;
+
+	FIntPoint GetCell(const FVector& Location) const;
+
+	TArray<TUniquePtr<FChunk>> Chunks;
+
+	TMap<FIntPoint, int32> ChunkIndices;
+
+	/** Indices of the chunks with heat in them */
+	TArray<int32> ActiveChunks;
+
+	/** Round robin position in ActiveChunks */
+	int32 UpdateCursor = 0;
+
+	/** Chunks of the current frame's update */
+	TArray<int32> Batch;
+
+	/** Chunks fire has reached but that do not exist yet, with the height to search the ground around */
+	TArray<TPair<FIntPoint, float>> PendingChunks;
+
+	/** Location and radius of the ignitions still waiting for some of their chunks */
+	TArray<TPair<FVector, float>> PendingIgnitions;
+
+	int32 NumBurningCells = 0;
+
+	uint32 Version = 0;
+};
@@ -0,0 +1,79 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FlyThroughTestSubsystem.generated.h"
+
+class AMyCharacterBase;
+
+/**
+ * Headless streaming test, created only when the game runs with -FlyThroughTest.
+ * Waits for the initial cells to stream in, then teleports the player along a scripted flight path at FlySpeed and
+ * records frame times, World Partition streaming state and used memory every frame. Frames longer than the hitch
+ * threshold are reported with whether streaming was in progress. Character movement is disabled during the flight,
+ * the streaming look-ahead is fed the flight velocity instead.
+ *
+ * Usage: UnrealEditor ZeldaLikeDemo.uproject <WorldPartitionMap> -game -nullrhi -nosound -unattended
+ *        -FlyThroughTest [-FlyPath="X,Y,Z;X,Y,Z;..."] [-FlySpeed=1800] [-FlyHitchMs=50] [-FlyMaxHitches=0]
+ *
+ * Without -FlyPath the player flies a square of 400 m sides from its start. Frames are written to
+ * Saved/Profiling/FlyThrough and the process exits with code 1 if there were more hitches than allowed.
+ */
+UCLASS()
+class ZELDALIKEDEMO_API UFlyThroughTestSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	/** Builds the path from -FlyPath, or a square around the player's start */
+	void BuildPath(const FVector& Start);
+
+	/** Moves the player along the path, returns false once the end is reached */
+	bool Fly(AMyCharacterBase* Character, float DeltaTime);
+
+	void Finish();
+
+	/** Path points, flown in order */
+	TArray<FVector> Path;
+
+	/** Text of -FlyPath, parsed once the player exists */
+	FString PathParam;
+
+	int32 NextPoint = 1;
+
+	/** Flying speed (in cm/s) */
+	float Speed = 1800.0f;
+
+	float HitchMs = 50.0f;
+	int32 MaxHitches = 0;
+
+	bool bStarted = false;
+	bool bFinished = false;
+
+	double LastFrameTime = 0.0;
+	double FlightTime = 0.0;
+
+	int32 NumFrames = 0;
+	int32 NumHitches = 0;
+	int32 NumStreamingHitches = 0;
+	float WorstFrameMs = 0.0f;
+	uint64 PeakUsedMemory = 0;
+	uint64 StartUsedMemory = 0;
+
+	/** Time, position, frame time, streaming and memory per frame */
+	TArray<FString> Lines;
+};
@@ -0,0 +1,49 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GliderPoolSubsystem.generated.h"
+
+class USkeletalMesh;
+class USkeletalMeshComponent;
+
+/**
+ * Small shared pool of glider mesh components.
+ * Characters borrow a glider only while gliding, so idle characters pay no pose or skinning cost for it.
+ */
+UCLASS()
+class ZELDALIKEDEMO_API UGliderPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Maximum number of released gliders kept around for reuse, extra ones are destroyed */
+	static constexpr int32 MaxFreeGliders = 4;
+
+	/**
+	 * Borrows a glider from the pool, creating one if the pool is empty.
+	 * @param Mesh - Glider mesh to display
+	 * @return A registered, hidden component with ticking disabled
+	 */
+	USkeletalMeshComponent* AcquireGlider(USkeletalMesh* Mesh);
+
+	/**
+	 * Returns a glider to the pool.
+	 * @param Glider - Component previously returned by AcquireGlider
+	 */
+	void ReleaseGlider(USkeletalMeshComponent* Glider);
+
+	virtual void Deinitialize() override;
+
+private:
+	/** Owner of every pooled component, so they outlive the characters that borrow them */
+	AActor* GetOrSpawnPoolOwner();
+
+	UPROPERTY()
+	TObjectPtr<AActor> PoolOwner;
+
+	UPROPERTY()
+	TArray<TObjectPtr<USkeletalMeshComponent>> FreeGliders;
+};
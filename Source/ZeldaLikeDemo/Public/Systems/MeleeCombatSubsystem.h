@@ -0,0 +1,160 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/HitResult.h"
+#include "GameFramework/DamageType.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MeleeCombatSubsystem.generated.h"
+
+class USkeletalMeshComponent;
+
+/**
+ * Blade and damage of one melee attack, set on the notify state that opens its active window.
+ */
+USTRUCT(BlueprintType)
+struct FMeleeAttackParams
+{
+	GENERATED_BODY()
+
+	/** Socket at the hilt end of the blade */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Melee")
+	FName BaseSocket = TEXT("weapon_base");
+
+	/** Socket at the tip of the blade */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Melee")
+	FName TipSocket = TEXT("weapon_tip");
+
+	/** Thickness of the swept blade */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Melee")
+	float Radius = 15.0f;
+
+	/** Damage dealt once per target per swing */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Melee")
+	float Damage = 10.0f;
+
+	/** Real time the attacker and the target freeze for on a hit (in seconds) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Melee")
+	float HitStopSeconds = 0.08f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Melee")
+	TSubclassOf<UDamageType> DamageType;
+};
+
+/**
+ * Hit detection for every melee swing in the world.
+ * Anim notify states open and close the active window of a swing. Each frame, after animation, the blade of every
+ * open swing is swept from its previous pose to its current one, in substeps when the tip moved far. All sweeps of
+ * the frame run as one batch across worker threads, then the hits are resolved on the game thread: each target is hit
+ * once per swing, members of the attacker's team are skipped, damage goes through UGameplayStatics::ApplyPointDamage
+ * and both sides freeze briefly for hit-stop.
+ * Swing slots, hit lists and result buffers are reused, so steady-state frames do not allocate.
+ */
+UCLASS(Config = Game)
+class ZELDALIKEDEMO_API UMeleeCombatSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Opens the active window of a swing, called from UMeleeWindowNotifyState::NotifyBegin.
+	 * @param Mesh - Mesh carrying the weapon sockets, its owner is the attacker
+	 * @param Source - Object opening the window, the same object closes it
+	 * @param Params - Blade and damage of the attack
+	 */
+	void BeginSwing(USkeletalMeshComponent* Mesh, const UObject* Source, const FMeleeAttackParams& Params);
+
+	/** Closes the window opened by BeginSwing with the same mesh and source */
+	void EndSwing(const USkeletalMeshComponent* Mesh, const UObject* Source);
+
+	/** Number of open swings */
+	int32 GetNumSwings() const { return Swings.Num(); }
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+	/** Time dilation of actors in hit-stop */
+	UPROPERTY(Config)
+	float HitStopTimeDilation = 0.05f;
+
+	/** Most sweeps per swing and frame, a swing is split so its tip moves about its thickness per substep */
+	UPROPERTY(Config)
+	int32 MaxSweepSubsteps = 4;
+
+	/** Fewer sweeps than this run on the game thread, handing them to workers costs more than it saves */
+	UPROPERTY(Config)
+	int32 MinParallelSweeps = 8;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	struct FSwing
+	{
+		TWeakObjectPtr<USkeletalMeshComponent> Mesh;
+		const UObject* Source = nullptr;
+		FMeleeAttackParams Params;
+
+		/** Blade at the previous sweep */
+		FVector PreviousBase = FVector::ZeroVector;
+		FVector PreviousTip = FVector::ZeroVector;
+
+		/** Targets already hit by this swing */
+		TArray<TWeakObjectPtr<AActor>, TInlineAllocator<8>> HitActors;
+	};
+
+	/** One blade sweep of the batch, filled on the game thread and read by the workers */
+	struct FSweep
+	{
+		FVector Start = FVector::ZeroVector;
+		FVector End = FVector::ZeroVector;
+		FQuat Rotation = FQuat::Identity;
+		float HalfHeight = 0.0f;
+		float Radius = 0.0f;
+		AActor* Attacker = nullptr;
+		int32 SwingIndex = 0;
+	};
+
+	/** A hit accepted this frame, applied after all swings are resolved */
+	struct FPendingHit
+	{
+		TWeakObjectPtr<AActor> Attacker;
+		TWeakObjectPtr<AActor> Target;
+		FHitResult Hit;
+		FVector Direction = FVector::ZeroVector;
+		float Damage = 0.0f;
+		float HitStopSeconds = 0.0f;
+		TSubclassOf<UDamageType> DamageType;
+	};
+
+	struct FHitStop
+	{
+		TWeakObjectPtr<AActor> Actor;
+		double EndTime = 0.0;
+	};
+
+	/** Runs the sweeps of the frame, one result array per sweep */
+	void RunSweeps();
+
+	/** Applies damage and hit-stop for the hits of the frame */
+	void ApplyHits();
+
+	/** Freezes an actor until the real time has passed, extends an active hit-stop */
+	void StartHitStop(AActor* Actor, double EndTime);
+
+	/** Restores actors whose hit-stop is over */
+	void UpdateHitStops(double Now);
+
+	TArray<FSwing> Swings;
+
+	TArray<FSweep> Sweeps;
+
+	/** Results of Sweeps, arrays keep their capacity between frames */
+	TArray<TArray<FHitResult>> SweepHits;
+
+	TArray<FPendingHit> PendingHits;
+
+	TArray<FHitStop> HitStops;
+};
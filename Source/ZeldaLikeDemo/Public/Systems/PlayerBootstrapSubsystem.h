@@ -0,0 +1,66 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "PlayerBootstrapSubsystem.generated.h"
+
+class UPlayerBootstrapData;
+struct FStreamableHandle;
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnPlayerBootstrapLoaded, const UPlayerBootstrapData*);
+
+/**
+ * Streams the PlayerBootstrap bundle in as soon as the game instance starts, in parallel with the first map load.
+ * Also reports how long the boot took until the first frame where the player could act.
+ * Pass -ExitAfterFirstPlayableFrame to quit once that frame is reached, e.g. for a headless -nullrhi timing run.
+ */
+UCLASS()
+class ZELDALIKEDEMO_API UPlayerBootstrapSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+	/**
+	 * Calls the delegate now if the bundle is loaded, otherwise once it arrives.
+	 * The data is null if no PlayerBootstrapData asset is registered.
+	 * @param Delegate - Callback receiving the loaded data
+	 */
+	void CallOrRegister_OnBootstrapLoaded(FOnPlayerBootstrapLoaded::FDelegate&& Delegate);
+
+	/** Called by the player character once its core assets are applied, ends the boot timing */
+	void NotifyPlayerReady();
+
+	UFUNCTION(BlueprintPure, Category = "Bootstrap")
+	bool IsBootstrapLoaded() const { return bLoaded; }
+
+private:
+	void OnBundleLoaded();
+
+	void OnFirstPlayableFrame();
+
+	FPrimaryAssetId BootstrapId;
+
+	UPROPERTY()
+	TObjectPtr<const UPlayerBootstrapData> BootstrapData;
+
+	/** Keeps the bundle resident for the lifetime of the game instance */
+	TSharedPtr<FStreamableHandle> LoadHandle;
+
+	FOnPlayerBootstrapLoaded OnLoaded;
+
+	bool bLoaded = false;
+	bool bPlayerReady = false;
+
+	/** Seconds since process start for each boot milestone */
+	double RequestedTime = 0.0;
+	double LoadedTime = 0.0;
+	double ReadyTime = 0.0;
+
+	FDelegateHandle EndFrameHandle;
+};
@@ -0,0 +1,127 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RuneNavigationSubsystem.generated.h"
+
+/**
+ * Feeds navmesh changes from rune geometry to the navigation system a few tiles at a time.
+ * Rune actors spawned through SpawnRuneActor register with navigation relevance off, so the engine does not dirty
+ * their tiles by itself. Their tiles are merged for CoalesceSeconds, so a burst of ice pillars in one spot rebuilds
+ * each tile once, then the geometry is made relevant in the frame its tiles are handed over. DespawnRuneActor does the
+ * same in reverse. At most MaxTilesPerFrame tiles are handed over per frame, nearest to the player first. The navmesh
+ * rebuilds them on worker threads (see [/Script/NavigationSystem.RecastNavMesh] in DefaultEngine.ini).
+ */
+UCLASS(Config = Game)
+class ZELDALIKEDEMO_API URuneNavigationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Tag of Blueprint components that become part of the navmesh with their rune actor, see SpawnRuneActor */
+	static const FName NavigationGeometryTag;
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+	/**
+	 * Spawns a rune actor whose geometry enters the navmesh once its tiles are due.
+	 * Native components that can affect navigation are switched off before they register. Components added by a
+	 * Blueprint register while spawning finishes, they need Can Ever Affect Navigation off and NavigationGeometryTag.
+	 * @param ActorClass - Rune actor to spawn
+	 * @param Transform - Where to spawn it
+	 * @param SpawnInstigator - Pawn using the rune, also the owner
+	 * @return The spawned actor, null if it could not be spawned
+	 */
+	AActor* SpawnRuneActor(TSubclassOf<AActor> ActorClass, const FTransform& Transform, APawn* SpawnInstigator);
+
+	/**
+	 * Removes a rune actor from the navmesh and destroys it once its tiles are due, e.g. when an ice pillar breaks.
+	 * The actor stays until then. An actor whose geometry has not reached the navmesh yet is destroyed right away.
+	 * @param Actor - Rune actor to remove
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Navigation")
+	void DespawnRuneActor(AActor* Actor);
+
+	/**
+	 * Marks the navmesh tiles under an area for rebuilding.
+	 * @param Bounds - World bounds of the geometry that appeared, moved or disappeared
+	 */
+	void NotifyNavigationChanged(const FBox& Bounds);
+
+	/**
+	 * Marks the navmesh tiles under an actor for rebuilding, for geometry the navigation system does not track.
+	 * @param Actor - Actor whose colliding components changed
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Navigation")
+	void NotifyActorNavigationChanged(AActor* Actor);
+
+	/** Time changes are collected before their tiles are rebuilt */
+	UPROPERTY(Config)
+	float CoalesceSeconds = 0.25f;
+
+	/** Tiles handed to the navigation system per frame */
+	UPROPERTY(Config)
+	int32 MaxTilesPerFrame = 4;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	/** A tile waiting for its coalescing window to end */
+	struct FDirtyTile
+	{
+		/** Time the tile was first marked */
+		double Time = 0.0;
+
+		/** Rune actors waiting on this tile */
+		int32 NumChanges = 0;
+
+		/** True if NotifyNavigationChanged marked it, such tiles are handed over by themselves */
+		bool bMarked = false;
+	};
+
+	/** A rune actor entering or leaving the navmesh once all of its tiles are due */
+	struct FGeometryChange
+	{
+		TWeakObjectPtr<AActor> Actor;
+
+		/** Components made relevant to navigation when the actor enters */
+		TArray<TWeakObjectPtr<UPrimitiveComponent>, TInlineAllocator<2>> Components;
+
+		/** True if the actor leaves and is destroyed */
+		bool bRemove = false;
+
+		TArray<FIntPoint, TInlineAllocator<4>> Tiles;
+	};
+
+	/** Edge length of navmesh tiles, from the default navmesh */
+	float GetTileSize() const;
+
+	/** Calls Visit for each navmesh tile under the bounds */
+	void ForEachTile(const FBox& Bounds, TFunctionRef<void(const FIntPoint&)> Visit) const;
+
+	/** Marks the tiles under the bounds of a change and queues it */
+	void QueueGeometryChange(FGeometryChange&& Change, const FBox& Bounds);
+
+	/** Drops the tiles of a change, bRebuilt if its geometry change dirtied them */
+	void ReleaseTiles(const FGeometryChange& Change, bool bRebuilt);
+
+	/** True once the coalescing window of every tile of the change has ended */
+	bool IsChangeDue(const FGeometryChange& Change, double Now) const;
+
+	/** Tiles waiting for their coalescing window to end */
+	TMap<FIntPoint, FDirtyTile> DirtyTiles;
+
+	/** Rune actors waiting to enter or leave the navmesh, oldest first */
+	TArray<FGeometryChange> GeometryChanges;
+
+	/** Time the oldest tile handed to the navigation system and not rebuilt yet was marked */
+	double OldestInFlightTime = -1.0;
+
+	/** Tiles due this frame, kept to avoid reallocating */
+	TArray<TPair<double, FIntPoint>> DueTiles;
+};
@@ -0,0 +1,75 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SoakTestSubsystem.generated.h"
+
+class AMyCharacterBase;
+
+/**
+ * Headless fast-forward soak test, created only when the game runs with -SoakTest.
+ * Switches the engine to a fixed time step without frame rate limiting, drives the player through walking,
+ * sprinting, gliding and temporary wind tunnels, and checks object, timer and memory counts periodically.
+ *
+ * Usage: UnrealEditor ZeldaLikeDemo.uproject -game -nullrhi -nosound -unattended -SoakTest
+ *        [-SoakStep=0.0166667] [-SoakHours=4] [-SoakCheckInterval=60] [-SoakMaxObjectGrowth=5000]
+ *        [-SoakMaxMemoryGrowthMB=256]
+ *
+ * The process exits with code 1 if any check failed.
+ */
+UCLASS()
+class ZELDALIKEDEMO_API USoakTestSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	/** Feeds scripted input to the player, one 40 second cycle of walk, sprint, jump and glide, then rest */
+	void DrivePlayer(AMyCharacterBase* Character);
+
+	/** Samples counts and compares them against the first sample */
+	void RunChecks();
+
+	/** Logs a failed check and remembers the failure for the exit code */
+	void Fail(const FString& Message);
+
+	void Finish();
+
+	/** Fixed simulation step (in seconds) */
+	float Step = 1.0f / 60.0f;
+
+	/** Simulated time to run before exiting (in seconds) */
+	double Duration = 3600.0;
+
+	/** Simulated time between checks (in seconds) */
+	double CheckInterval = 60.0;
+
+	int32 MaxObjectGrowth = 5000;
+	int64 MaxMemoryGrowthBytes = 256ll * 1024 * 1024;
+
+	double SimulatedTime = 0.0;
+	double NextCheckTime = 0.0;
+	double NextWindTunnelTime = 0.0;
+	double StartWallTime = 0.0;
+
+	/** Counts from the first check, later checks compare against them */
+	int32 BaselineObjects = INDEX_NONE;
+	uint64 BaselineMemory = 0;
+
+	int32 NumChecks = 0;
+	int32 NumFailures = 0;
+	bool bFinished = false;
+};
@@ -0,0 +1,62 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Telemetry/TelemetryLog.h"
+#include "TelemetrySubsystem.generated.h"
+
+/**
+ * Records gameplay events of the session to Saved/Telemetry/Session-<time>.zlt for Tools/TelemetryAnalyzer.
+ * Recording copies a fixed-size record into a memory-mapped file and stays on in shipping builds.
+ * Pass -NoTelemetry to disable it.
+ */
+UCLASS(Config = Game)
+class ZELDALIKEDEMO_API UTelemetrySubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+	/**
+	 * Appends an event to the log.
+	 * @param Event - What happened, see Telemetry::EEvent for the meaning of the arguments
+	 */
+	FORCEINLINE void Record(Telemetry::EEvent Event, uint8 Arg0 = 0, uint8 Arg1 = 0, float Value = 0.0f,
+	                        uint32 Subject = 0)
+	{
+		Telemetry::FRecord Record;
+		Record.Time = FPlatformTime::Seconds() - SessionStartSeconds;
+		Record.Frame = static_cast<uint32>(GFrameCounter);
+		Record.Event = Event;
+		Record.Arg0 = Arg0;
+		Record.Arg1 = Arg1;
+		Record.Reserved = 0;
+		Record.Value = Value;
+		Record.Subject = Subject;
+		Log.Append(Record);
+	}
+
+	/**
+	 * Names a subject id, written next to the log for the analyzer.
+	 * Called once per subject, e.g. when a wind tunnel begins play.
+	 */
+	void SetSubjectName(uint32 Subject, const FString& Name);
+
+	/** Number of records the log file holds */
+	UPROPERTY(Config)
+	uint32 MaxRecords = 262144;
+
+private:
+	FTelemetryLog Log;
+
+	FString LogPath;
+
+	double SessionStartSeconds = 0.0;
+
+	TMap<uint32, FString> SubjectNames;
+};
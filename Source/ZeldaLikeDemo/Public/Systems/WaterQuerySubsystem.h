@@ -0,0 +1,96 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WaterQuerySubsystem.generated.h"
+
+class AWaterRegion;
+
+/**
+ * Water found at a location.
+ */
+USTRUCT(BlueprintType)
+struct FWaterSample
+{
+	GENERATED_BODY()
+
+	/** True if any water covers the location horizontally */
+	UPROPERTY(BlueprintReadOnly, Category = "Water")
+	bool bHasWater = false;
+
+	/** Height of the water surface */
+	UPROPERTY(BlueprintReadOnly, Category = "Water")
+	float SurfaceHeight = 0.0f;
+
+	/** Height of the bottom of the water */
+	UPROPERTY(BlueprintReadOnly, Category = "Water")
+	float BottomHeight = 0.0f;
+
+	/** Current at the surface (in cm/s) */
+	UPROPERTY(BlueprintReadOnly, Category = "Water")
+	FVector Flow{FVector::ZeroVector};
+
+	/** Checks whether a height lies between the bottom and the surface */
+	bool IsSubmerged(float Height) const { return bHasWater && Height <= SurfaceHeight && Height >= BottomHeight; }
+};
+
+/**
+ * Caches water height and flow per grid cell.
+ * Swimmers, Cryonis placement and glide landing checks query this instead of testing water volumes or tracing every
+ * frame. A cell is resolved once from the few regions in its bucket, later queries are a single hash lookup, so
+ * cost stays flat as swimmers and water bodies are added.
+ */
+UCLASS()
+class ZELDALIKEDEMO_API UWaterQuerySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Edge length of a cached cell */
+	static constexpr float CellSize = 200.0f;
+
+	/** Edge length of a region bucket, each cell only tests regions in its bucket */
+	static constexpr float BucketSize = 5000.0f;
+
+	/** The cache is flushed when it grows past this many cells */
+	static constexpr int32 MaxCachedCells = 65536;
+
+	/** Adds a water region, called from AWaterRegion::BeginPlay */
+	void RegisterWaterRegion(AWaterRegion* Region);
+
+	/** Removes a water region, called from AWaterRegion::EndPlay */
+	void UnregisterWaterRegion(AWaterRegion* Region);
+
+	/**
+	 * Gets the water covering a location.
+	 * Returned by value, the cache may grow or flush before a caller is done with the sample.
+	 * @param Location - World location, only X and Y select the cell
+	 */
+	FWaterSample Query(const FVector& Location);
+
+	/**
+	 * Blueprint access to Query, e.g. to place Cryonis (R_ICE) blocks on the surface.
+	 * @param Location - World location to sample
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Water")
+	FWaterSample QueryWater(const FVector& Location);
+
+private:
+	static FIntPoint ToKey(const FVector& Location, float Size);
+
+	/** Resolves a cell from the regions of its bucket */
+	FWaterSample BuildCell(const FIntPoint& Cell) const;
+
+	/** Drops the cached cells under a region so they are resolved again */
+	void InvalidateRegion(const AWaterRegion* Region);
+
+	/** Calls Visitor for every bucket key a region's bounds overlap */
+	template <typename FunctorType>
+	static void ForEachBucket(const FBox& Bounds, FunctorType&& Visitor);
+
+	TMap<FIntPoint, TArray<TWeakObjectPtr<AWaterRegion>>> Buckets;
+
+	TMap<FIntPoint, FWaterSample> Cells;
+};
@@ -0,0 +1,46 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WindFieldSubsystem.generated.h"
+
+class AWindTunnel;
+
+/**
+ * Registry of every wind source in the world.
+ * Lets gameplay code sample wind lift at a location without iterating actors.
+ */
+UCLASS()
+class ZELDALIKEDEMO_API UWindFieldSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Adds a wind tunnel to the registry, called from AWindTunnel::BeginPlay */
+	void RegisterWindTunnel(AWindTunnel* WindTunnel);
+
+	/** Removes a wind tunnel from the registry, called from AWindTunnel::EndPlay */
+	void UnregisterWindTunnel(AWindTunnel* WindTunnel);
+
+	/**
+	 * Sums the lift velocity of every wind tunnel containing the location and the thermal updraft of fires.
+	 * @param Location - World location to sample
+	 * @return Lift velocity in cm/s
+	 */
+	FVector SampleLiftVelocity(const FVector& Location) const;
+
+	/**
+	 * Changes whenever a wind tunnel is added or removed or fires start, spread or burn out, so cached predictions
+	 * can be invalidated.
+	 */
+	uint32 GetVersion() const;
+
+private:
+	UPROPERTY()
+	TArray<TObjectPtr<AWindTunnel>> WindTunnels;
+
+	/** Incremented whenever a wind tunnel is added or removed */
+	uint32 TunnelVersion = 0;
+};
@@ -0,0 +1,64 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Shared with Tools/TelemetryAnalyzer, which builds without the engine, so only standard types are used here
+#include <cstdint>
+
+namespace Telemetry
+{
+	/** "ZLTL" */
+	constexpr uint32_t FileMagic = 0x4C544C5A;
+	constexpr uint16_t FileVersion = 1;
+
+	/**
+	 * Recorded events. Values are stored in the log, only append.
+	 */
+	enum class EEvent : uint8_t
+	{
+		None = 0,
+		LocomotionChanged = 1, // Arg0 previous EMovementTypes, Arg1 new EMovementTypes, Value stamina
+		StaminaEmpty = 2, // Arg0 EMovementTypes that drained it
+		StaminaFull = 3,
+		WindTunnelEnter = 4, // Subject wind tunnel id
+		WindTunnelExit = 5, // Subject wind tunnel id, Value seconds spent inside
+		RuneSelected = 6, // Arg0 ERunes
+	};
+
+	/**
+	 * Start of a log file, followed by Capacity records of which the first NumRecords are valid.
+	 */
+	struct FFileHeader
+	{
+		uint32_t Magic;
+		uint16_t Version;
+		uint16_t RecordSize;
+		uint32_t Capacity;
+		/** Updated after every record, so a crashed session still reads back */
+		uint32_t NumRecords;
+		/** Records that did not fit */
+		uint32_t NumDropped;
+		uint32_t Reserved;
+		/** Unix time the session started at */
+		int64_t SessionStartTime;
+	};
+
+	/**
+	 * One fixed-size event.
+	 */
+	struct FRecord
+	{
+		/** Seconds since the session started */
+		double Time;
+		uint32_t Frame;
+		EEvent Event;
+		uint8_t Arg0;
+		uint8_t Arg1;
+		uint8_t Reserved;
+		float Value;
+		uint32_t Subject;
+	};
+
+	static_assert(sizeof(FFileHeader) == 32, "The header layout is part of the file format");
+	static_assert(sizeof(FRecord) == 24, "The record layout is part of the file format");
+}
@@ -0,0 +1,78 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Telemetry/TelemetryFormat.h"
+
+/**
+ * Append-only event log in a memory-mapped file.
+ * The file is sized for its capacity when opened, so appending copies one record into the mapping and never
+ * allocates or calls into the file system. The OS writes the pages back, even if the game crashes.
+ * Records past the capacity are counted and dropped. Not thread safe.
+ */
+class ZELDALIKEDEMO_API FTelemetryLog
+{
+public:
+	FTelemetryLog() = default;
+	~FTelemetryLog();
+
+	FTelemetryLog(const FTelemetryLog&) = delete;
+	FTelemetryLog& operator=(const FTelemetryLog&) = delete;
+
+	/**
+	 * Creates the log file and maps it.
+	 * @param Path - File to create, replaced if it exists
+	 * @param Capacity - Number of records the file holds
+	 * @param SessionStartTime - Unix time stored in the header
+	 * @return true if the log is ready for recording
+	 */
+	bool Open(const FString& Path, uint32 Capacity, int64 SessionStartTime);
+
+	/** Unmaps the file and trims it to the recorded events */
+	void Close();
+
+	bool IsOpen() const { return Header != nullptr; }
+
+	uint32 GetNumRecords() const { return Header ? Header->NumRecords : 0; }
+
+	uint32 GetNumDropped() const { return Header ? Header->NumDropped : 0; }
+
+	FORCEINLINE void Append(const Telemetry::FRecord& Record)
+	{
+		if (!Header) return;
+
+		if (Header->NumRecords >= Header->Capacity)
+		{
+			++Header->NumDropped;
+			return;
+		}
+
+		// Write the record before publishing it in the header
+		Records[Header->NumRecords] = Record;
+		++Header->NumRecords;
+	}
+
+private:
+	/** Maps Size bytes of a new file at Path, returns the view or nullptr */
+	uint8* MapFile(const FString& Path, int64 Size);
+
+	/** Unmaps the view and trims the file to Size bytes */
+	void UnmapFile(int64 Size);
+
+	Telemetry::FFileHeader* Header = nullptr;
+	Telemetry::FRecord* Records = nullptr;
+
+	uint8* View = nullptr;
+	int64 ViewSize = 0;
+
+#if PLATFORM_WINDOWS
+	void* FileHandle = nullptr;
+	void* MappingHandle = nullptr;
+#elif PLATFORM_UNIX || PLATFORM_MAC
+	int32 FileDescriptor = -1;
+#else
+	/** Without file mapping the log lives in memory and is written out on close */
+	FString FallbackPath;
+#endif
+};
@@ -3,4 +3,6 @@
 #include "ZeldaLikeDemo.h"
 #include "Modules/ModuleManager.h"
 
+DEFINE_LOG_CATEGORY(LogZeldaLikeDemo);
+
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, ZeldaLikeDemo, "ZeldaLikeDemo" );
@@ -3,4 +3,8 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Stats/Stats.h"
 
+ZELDALIKEDEMO_API DECLARE_LOG_CATEGORY_EXTERN(LogZeldaLikeDemo, Log, All);
+
+DECLARE_STATS_GROUP(TEXT("ZeldaLikeDemo"), STATGROUP_ZeldaLikeDemo, STATCAT_Advanced);
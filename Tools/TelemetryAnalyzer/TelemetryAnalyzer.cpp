@@ -0,0 +1,246 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+/**
+ * Summarizes telemetry logs written by UTelemetrySubsystem (Saved/Telemetry/Session-*.zlt).
+ * Builds without the engine:
+ *
+ *   c++ -std=c++17 -O2 -I Source/ZeldaLikeDemo/Public Tools/TelemetryAnalyzer/TelemetryAnalyzer.cpp -o TelemetryAnalyzer
+ *   TelemetryAnalyzer Saved/Telemetry/Session-*.zlt
+ *
+ * Several logs are summarized together.
+ */
+
+#include "Telemetry/TelemetryFormat.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace
+{
+	// Follow the order of EMovementTypes and ERunes in MyCharacterBase.h
+	const char* const MovementNames[] = {
+		"Max", "Walking", "Exhausted", "Sprinting", "Gliding", "Falling", "Climbing", "Swimming"
+	};
+	const char* const RuneNames[] = {"EMax", "RBS", "RBB", "MAGNET", "STATICS", "ICE"};
+
+	constexpr uint8_t MovementGliding = 4;
+
+	template <size_t N>
+	std::string NameOf(const char* const (&Names)[N], uint8_t Value)
+	{
+		return Value < N ? Names[Value] : "#" + std::to_string(Value);
+	}
+
+	struct FWindTunnelUsage
+	{
+		int Entries = 0;
+		double SecondsInside = 0.0;
+	};
+
+	struct FSummary
+	{
+		int NumSessions = 0;
+		double SessionSeconds = 0.0;
+		uint64_t NumRecords = 0;
+		uint64_t NumDropped = 0;
+
+		int NumExhausted = 0;
+		std::map<std::string, int> ExhaustedBy;
+		int NumStaminaFull = 0;
+
+		std::vector<double> GlideSeconds;
+		std::map<std::pair<uint8_t, uint8_t>, int> Transitions;
+		std::map<uint32_t, FWindTunnelUsage> WindTunnels;
+		std::map<uint32_t, std::string> WindTunnelNames;
+		std::map<std::string, int> Runes;
+	};
+
+	void ReadNames(const std::string& Path, FSummary& Summary)
+	{
+		std::ifstream File(Path + ".names");
+		std::string Line;
+		while (std::getline(File, Line))
+		{
+			const size_t Comma = Line.find(',');
+			if (Comma == std::string::npos) continue;
+			Summary.WindTunnelNames[static_cast<uint32_t>(std::stoul(Line.substr(0, Comma)))] = Line.substr(Comma + 1);
+		}
+	}
+
+	bool ReadLog(const std::string& Path, FSummary& Summary)
+	{
+		std::ifstream File(Path, std::ios::binary);
+		if (!File)
+		{
+			std::fprintf(stderr, "%s: cannot open\n", Path.c_str());
+			return false;
+		}
+
+		Telemetry::FFileHeader Header{};
+		if (!File.read(reinterpret_cast<char*>(&Header), sizeof(Header)) || Header.Magic != Telemetry::FileMagic)
+		{
+			std::fprintf(stderr, "%s: not a telemetry log\n", Path.c_str());
+			return false;
+		}
+		if (Header.Version != Telemetry::FileVersion || Header.RecordSize != sizeof(Telemetry::FRecord))
+		{
+			std::fprintf(stderr, "%s: unsupported version %u\n", Path.c_str(), Header.Version);
+			return false;
+		}
+
+		// A crashed session may not have trimmed the file, NumRecords is always current
+		std::vector<Telemetry::FRecord> Records(Header.NumRecords);
+		File.read(reinterpret_cast<char*>(Records.data()), Records.size() * sizeof(Telemetry::FRecord));
+		Records.resize(static_cast<size_t>(File.gcount()) / sizeof(Telemetry::FRecord));
+
+		++Summary.NumSessions;
+		Summary.NumRecords += Records.size();
+		Summary.NumDropped += Header.NumDropped;
+		if (!Records.empty())
+		{
+			Summary.SessionSeconds += Records.back().Time;
+		}
+		ReadNames(Path, Summary);
+
+		double GlideStart = -1.0;
+		for (const Telemetry::FRecord& Record : Records)
+		{
+			switch (Record.Event)
+			{
+			case Telemetry::EEvent::LocomotionChanged:
+				++Summary.Transitions[{Record.Arg0, Record.Arg1}];
+				if (Record.Arg1 == MovementGliding)
+				{
+					GlideStart = Record.Time;
+				}
+				else if (Record.Arg0 == MovementGliding && GlideStart >= 0.0)
+				{
+					Summary.GlideSeconds.push_back(Record.Time - GlideStart);
+					GlideStart = -1.0;
+				}
+				break;
+			case Telemetry::EEvent::StaminaEmpty:
+				++Summary.NumExhausted;
+				++Summary.ExhaustedBy[NameOf(MovementNames, Record.Arg0)];
+				break;
+			case Telemetry::EEvent::StaminaFull:
+				++Summary.NumStaminaFull;
+				break;
+			case Telemetry::EEvent::WindTunnelEnter:
+				++Summary.WindTunnels[Record.Subject].Entries;
+				break;
+			case Telemetry::EEvent::WindTunnelExit:
+				Summary.WindTunnels[Record.Subject].SecondsInside += Record.Value;
+				break;
+			case Telemetry::EEvent::RuneSelected:
+				++Summary.Runes[NameOf(RuneNames, Record.Arg0)];
+				break;
+			default:
+				break;
+			}
+		}
+		return true;
+	}
+
+	double Percentile(const std::vector<double>& Sorted, double Fraction)
+	{
+		const size_t Index = static_cast<size_t>(Fraction * (Sorted.size() - 1) + 0.5);
+		return Sorted[Index];
+	}
+
+	void Print(FSummary& Summary)
+	{
+		const double Minutes = Summary.SessionSeconds / 60.0;
+		std::printf("Sessions: %d, %.1f minutes, %llu events (%llu dropped)\n", Summary.NumSessions, Minutes,
+		            static_cast<unsigned long long>(Summary.NumRecords),
+		            static_cast<unsigned long long>(Summary.NumDropped));
+
+		std::printf("\nStamina\n");
+		std::printf("  exhausted %d times (%.2f per minute), fully recovered %d times\n", Summary.NumExhausted,
+		            Minutes > 0.0 ? Summary.NumExhausted / Minutes : 0.0, Summary.NumStaminaFull);
+		for (const auto& [Movement, Count] : Summary.ExhaustedBy)
+		{
+			std::printf("  exhausted while %-10s %d\n", Movement.c_str(), Count);
+		}
+
+		std::printf("\nGlides\n");
+		if (Summary.GlideSeconds.empty())
+		{
+			std::printf("  none\n");
+		}
+		else
+		{
+			std::vector<double>& Glides = Summary.GlideSeconds;
+			std::sort(Glides.begin(), Glides.end());
+			double Total = 0.0;
+			for (const double Seconds : Glides)
+			{
+				Total += Seconds;
+			}
+			std::printf("  %zu glides, mean %.2f s, median %.2f s, p90 %.2f s, longest %.2f s\n", Glides.size(),
+			            Total / Glides.size(), Percentile(Glides, 0.5), Percentile(Glides, 0.9), Glides.back());
+		}
+
+		std::printf("\nWind tunnels\n");
+		std::vector<std::pair<uint32_t, FWindTunnelUsage>> Tunnels(Summary.WindTunnels.begin(),
+		                                                            Summary.WindTunnels.end());
+		std::sort(Tunnels.begin(), Tunnels.end(), [](const auto& A, const auto& B)
+		{
+			return A.second.Entries > B.second.Entries;
+		});
+		for (const auto& [Id, Usage] : Tunnels)
+		{
+			const auto Name = Summary.WindTunnelNames.find(Id);
+			std::printf("  %-60s %5d entries %8.1f s inside\n",
+			            Name != Summary.WindTunnelNames.end() ? Name->second.c_str() : std::to_string(Id).c_str(),
+			            Usage.Entries, Usage.SecondsInside);
+		}
+		if (Tunnels.empty())
+		{
+			std::printf("  none\n");
+		}
+
+		std::printf("\nRune selections\n");
+		for (const auto& [Rune, Count] : Summary.Runes)
+		{
+			std::printf("  %-10s %d\n", Rune.c_str(), Count);
+		}
+		if (Summary.Runes.empty())
+		{
+			std::printf("  none\n");
+		}
+
+		std::printf("\nLocomotion transitions\n");
+		for (const auto& [Transition, Count] : Summary.Transitions)
+		{
+			std::printf("  %-10s -> %-10s %d\n", NameOf(MovementNames, Transition.first).c_str(),
+			            NameOf(MovementNames, Transition.second).c_str(), Count);
+		}
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	if (Argc < 2)
+	{
+		std::fprintf(stderr, "Usage: %s Session.zlt [Session.zlt...]\n", Argv[0]);
+		return 2;
+	}
+
+	FSummary Summary;
+	int Result = 0;
+	for (int Index = 1; Index < Argc; ++Index)
+	{
+		if (!ReadLog(Argv[Index], Summary))
+		{
+			Result = 1;
+		}
+	}
+
+	Print(Summary);
+	return Result;
+}